@@ -0,0 +1,21 @@
+QT += core testlib
+QT -= gui
+
+TARGET = Benchmark
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+SOURCES += benchmark.cpp \
+        ../messagedecoder.cpp \
+        ../valueparser.cpp \
+        ../alarmengine.cpp
+
+HEADERS += ../messagedecoder.h \
+        ../valueparser.h \
+        ../alarmengine.h \
+        ../sample.h
+
+CONFIG += C++14 console
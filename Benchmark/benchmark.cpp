@@ -0,0 +1,159 @@
+/*!
+ * \file benchmark.cpp
+ */
+#include <QtTest>
+#include "messagedecoder.h"
+#include "alarmengine.h"
+
+const QString TEST_MESSAGE =
+"{\"name\":\"Vin\",\"value\":\"14.257 V\",\"time\":\"2017/09/02 - 01:18:30\"}";
+/*!< Same message WebSocketTest sends with Ctrl+T */
+const QString SPACED_MESSAGE =
+"{ \"name\" : \"Vin\", \"value\" : \"14.257 V\", "
+"\"time\" : \"2017/09/02 - 01:18:30\" }"; /*!< Message with whitespace */
+const QString LONG_MESSAGE =
+"{\"name\":\"Rack 12 / Slot 4 / Channel 31 Input Voltage\","
+"\"value\":\"-0.000123456789 mV\",\"time\":\"2017/09/02 - 01:18:30.123456\"}";
+/*!< Message with long field values */
+const QString BATCH_MESSAGE =
+"{\"time\":\"2017/09/02 - 01:18:30\",\"values\":{\"Vin\":\"14.257 V\","
+"\"Iout\":\"1.203 A\",\"Temp\":\"41.5 C\"}}"; /*!< Batch message */
+
+/*!
+ * \brief Benchmarks for the message decoders and the per sample
+ * alarm evaluation
+ *
+ * Run with e.g. -o result.csv,csv for machine-readable results
+ */
+class DecoderBenchmark : public QObject {
+    Q_OBJECT
+
+private:
+    void addMessages();
+
+private slots:
+    void fastDecoder_data();
+    void fastDecoder();
+    void fastDecoderSample_data();
+    void fastDecoderSample();
+    void jsonDecoder_data();
+    void jsonDecoder();
+    void batchDecoder_data();
+    void batchDecoder();
+    void alarmEngine_data();
+    void alarmEngine();
+};
+
+/*!
+ * \brief Adds the benchmarked messages as test data rows
+ */
+void DecoderBenchmark::addMessages() {
+    QTest::addColumn<QString>("message");
+    QTest::newRow("test message") << TEST_MESSAGE;
+    QTest::newRow("spaced message") << SPACED_MESSAGE;
+    QTest::newRow("long message") << LONG_MESSAGE;
+}
+
+void DecoderBenchmark::fastDecoder_data() {
+    addMessages();
+}
+
+/*!
+ * \brief Fast path decoding into string views
+ */
+void DecoderBenchmark::fastDecoder() {
+    QFETCH(QString, message);
+    MessageView view;
+    QVERIFY(MessageDecoder::decodeFast(message, view));
+    QBENCHMARK {
+        MessageDecoder::decodeFast(message, view);
+    }
+}
+
+void DecoderBenchmark::fastDecoderSample_data() {
+    addMessages();
+}
+
+/*!
+ * \brief Fast path decoding including copying the fields into a Sample
+ */
+void DecoderBenchmark::fastDecoderSample() {
+    QFETCH(QString, message);
+    Sample sample;
+    QBENCHMARK {
+        MessageDecoder::decode(message, sample);
+    }
+}
+
+void DecoderBenchmark::jsonDecoder_data() {
+    addMessages();
+}
+
+/*!
+ * \brief QJsonDocument decoding into a Sample
+ */
+void DecoderBenchmark::jsonDecoder() {
+    QFETCH(QString, message);
+    Sample sample;
+    QVERIFY(MessageDecoder::decodeJson(message, sample));
+    QBENCHMARK {
+        MessageDecoder::decodeJson(message, sample);
+    }
+}
+
+void DecoderBenchmark::batchDecoder_data() {
+    QTest::addColumn<QString>("message");
+    QTest::addColumn<bool>("fast");
+    QTest::newRow("fast") << BATCH_MESSAGE << true;
+    QTest::newRow("json") << BATCH_MESSAGE << false;
+}
+
+/*!
+ * \brief Batch decoding into Samples with and without the fast path
+ */
+void DecoderBenchmark::batchDecoder() {
+    QFETCH(QString, message);
+    QFETCH(bool, fast);
+    MessageDecoder decoder;
+    QVector<Sample> samples;
+    QBENCHMARK {
+        samples.clear();
+        if (fast) decoder.decode(message, samples);
+        else MessageDecoder::decodeJson(message, samples);
+    }
+    QCOMPARE(samples.size(), 3);
+}
+
+void DecoderBenchmark::alarmEngine_data() {
+    QTest::addColumn<QStringList>("conditions");
+    QTest::newRow("no rules") << QStringList();
+    QTest::newRow("value") << QStringList({"< 11.5 for 2s"});
+    QTest::newRow("value with unit") << QStringList({"< 11.5 V for 2s"});
+    QTest::newRow("rate") << QStringList({"rate > 0.5"});
+    QTest::newRow("all kinds") << QStringList({"< 11.5 V for 2s", "> 15",
+                                               "rate > 0.5", "missing 5s"});
+}
+
+/*!
+ * \brief Evaluating the rules of a parameter for a decoded sample
+ */
+void DecoderBenchmark::alarmEngine() {
+    QFETCH(QStringList, conditions);
+    AlarmEngine engine;
+    for (const QString &condition : conditions) {
+        QVERIFY(engine.addRule("Vin", condition));
+    }
+    engine.bind(0, "Vin", 0);
+    Sample sample;
+    QVERIFY(MessageDecoder::decode(TEST_MESSAGE, sample));
+    qint64 now = 0;
+    QBENCHMARK {
+        now += 1000;
+        engine.evaluate(0, sample, now);
+    }
+    QVERIFY(!engine.isActive(0));
+}
+
+QTEST_APPLESS_MAIN(DecoderBenchmark)
+
+#include "benchmark.moc"
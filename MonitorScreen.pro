@@ -8,9 +8,53 @@ TEMPLATE = app
 DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += main.cpp\
-        monitorwindow.cpp
+        monitorwindow.cpp \
+        ingestionworker.cpp \
+        messagedecoder.cpp \
+        parameterregistry.cpp \
+        binaryprotocol.cpp \
+        valueparser.cpp \
+        historybuffer.cpp \
+        trendchart.cpp \
+        dashboard.cpp \
+        fontfitter.cpp \
+        valueview.cpp \
+        parametermodel.cpp \
+        subscription.cpp \
+        performancestats.cpp \
+        timeparser.cpp \
+        latencyhistogram.cpp \
+        alarmengine.cpp \
+        rollingstats.cpp \
+        recorder.cpp \
+        replayer.cpp \
+        statesnapshot.cpp \
+        relayserver.cpp
 
-HEADERS += monitorwindow.h
+HEADERS += monitorwindow.h \
+        ingestionworker.h \
+        samplequeue.h \
+        sample.h \
+        messagedecoder.h \
+        parameterregistry.h \
+        binaryprotocol.h \
+        valueparser.h \
+        historybuffer.h \
+        trendchart.h \
+        dashboard.h \
+        fontfitter.h \
+        valueview.h \
+        parametermodel.h \
+        subscription.h \
+        performancestats.h \
+        timeparser.h \
+        latencyhistogram.h \
+        alarmengine.h \
+        rollingstats.h \
+        recorder.h \
+        replayer.h \
+        statesnapshot.h \
+        relayserver.h
 
 FORMS    += monitorwindow.ui
 
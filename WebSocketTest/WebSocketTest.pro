@@ -8,10 +8,27 @@ TEMPLATE = app
 
 DEFINES += QT_DEPRECATED_WARNINGS
 
+INCLUDEPATH += ..
+
 SOURCES += main.cpp \
-        websockettest.cpp
+        websockettest.cpp \
+        fanoutserver.cpp \
+        logbuffer.cpp \
+        loadgenerator.cpp \
+        ../messagedecoder.cpp \
+        ../valueparser.cpp \
+        ../binaryprotocol.cpp \
+        ../subscription.cpp
 
-HEADERS += websockettest.h
+HEADERS += websockettest.h \
+        fanoutserver.h \
+        logbuffer.h \
+        loadgenerator.h \
+        ../messagedecoder.h \
+        ../valueparser.h \
+        ../binaryprotocol.h \
+        ../subscription.h \
+        ../sample.h
 
 FORMS += websockettest.ui
 
@@ -0,0 +1,365 @@
+#include "fanoutserver.h"
+
+FanoutServer::FanoutServer(QObject *parent) : QObject(parent),
+    server(new QWebSocketServer(FANOUT_NAME, QWebSocketServer::NonSecureMode,
+                                this)),
+    policy(DropOldest), queueLimit(CLIENT_QUEUE_MAX), catalogChanged(false),
+    bytesSent(0), bytesSaved(0), dropped(0) {
+
+    QObject::connect(server, SIGNAL(newConnection()), this,
+                     SLOT(connected()));
+    QTimer *timer = new QTimer(this);
+    QObject::connect(timer, SIGNAL(timeout()), this, SLOT(sendCatalog()));
+    timer->start(CATALOG_INTERVAL);
+}
+
+bool FanoutServer::listen(quint16 port) {
+    return server->listen(QHostAddress::Any, port);
+}
+
+void FanoutServer::close() {
+    server->close();
+}
+
+quint16 FanoutServer::port() const {
+    return server->serverPort();
+}
+
+void FanoutServer::setPolicy(DropPolicy policy) {
+    this->policy = policy;
+}
+
+void FanoutServer::setQueueLimit(int limit) {
+    queueLimit = qMax(limit, 1);
+}
+
+int FanoutServer::clientCount() const {
+    return clients.size();
+}
+
+QString FanoutServer::statistics() const {
+    return STATS_TEXT.arg(clients.size()).arg(bytesSent).arg(bytesSaved)
+                     .arg(dropped);
+}
+
+LogBuffer &FanoutServer::log() {
+    return logBuffer;
+}
+
+bool FanoutServer::parsePolicy(const QString &text, DropPolicy &policy) {
+    if (text == DROP_OLDEST_POLICY) policy = DropOldest;
+    else if (text == LATEST_ONLY_POLICY) policy = LatestOnly;
+    else return false;
+    return true;
+}
+
+void FanoutServer::addSample(BinaryEncoder &encoder, const Sample &sample) {
+    qint64 timestamp = sample.timestamp;
+    if (!timestamp) {
+        QDateTime time = QDateTime::fromString(sample.time, TIME_FORMAT);
+        if (time.isValid()) timestamp = time.toMSecsSinceEpoch() * 1000;
+    }
+    if (sample.format == SAMPLE_FLOAT) {
+        encoder.addDouble(sample.name, sample.number, sample.unit, timestamp);
+        return;
+    }
+    if (sample.format == SAMPLE_INTEGER) {
+        encoder.addInteger(sample.name, qint64(sample.number), sample.unit,
+                           timestamp);
+        return;
+    }
+    QString unit = sample.value.section(' ', 1);
+    bool isNumber;
+    double number = sample.value.section(' ', 0, 0).toDouble(&isNumber);
+    if (isNumber && sample.hasNumber) number = sample.number;
+
+    if (isNumber) encoder.addDouble(sample.name, number, unit, timestamp);
+    else encoder.addString(sample.name, sample.value, timestamp);
+}
+
+void FanoutServer::broadcast(const QString &message) {
+    samples.clear();
+    decoder.decode(message, samples);
+    addToCatalog();
+    Message shared = textMessage(message);
+    if (samples.size() == 1) shared.key = samples.first().name;
+
+    filtered.clear();
+    for (auto i = clients.begin(); i != clients.end(); ++i) {
+        Client &client = i.value();
+        if (samples.isEmpty() || !client.subscribed) {
+            enqueue(i.key(), client, shared);
+            continue;
+        }
+        Filtered result = filter(client, false);
+        if (result.count == samples.size()) {
+            enqueue(i.key(), client, shared);
+            continue;
+        }
+        bytesSaved += shared.size;
+        if (!result.count) continue;
+        bytesSaved -= result.message.size;
+        enqueue(i.key(), client, result.message);
+    }
+    logBuffer.append(TEXT_LOG_TEXT + message);
+}
+
+void FanoutServer::broadcastBinary(const QByteArray &message) {
+    samples.clear();
+    binaryDecoder.decode(message, samples);
+    addToCatalog();
+    Message shared = binaryMessage(message);
+    if (samples.size() == 1) shared.key = samples.first().name;
+
+    filtered.clear();
+    for (auto i = clients.begin(); i != clients.end(); ++i) {
+        Client &client = i.value();
+        if (samples.isEmpty() || !client.subscribed) {
+            enqueue(i.key(), client, shared);
+            continue;
+        }
+        Filtered result = filter(client, true);
+        if (result.count == samples.size()) {
+            enqueue(i.key(), client, shared);
+            continue;
+        }
+        bytesSaved += shared.size;
+        if (!result.count) continue;
+        bytesSaved -= result.message.size;
+        enqueue(i.key(), client, result.message);
+    }
+    logBuffer.append(BINARY_LOG_TEXT.arg(message.size()));
+}
+
+void FanoutServer::connected() {
+    while (server->hasPendingConnections()) {
+        QWebSocket *socket = server->nextPendingConnection();
+        QObject::connect(socket, SIGNAL(textMessageReceived(QString)), this,
+                         SLOT(messageReceived(QString)));
+        QObject::connect(socket, SIGNAL(binaryMessageReceived(QByteArray)),
+                         this, SLOT(broadcastBinary(QByteArray)));
+        QObject::connect(socket, SIGNAL(bytesWritten(qint64)), this,
+                         SLOT(bytesWritten(qint64)));
+        QObject::connect(socket, SIGNAL(disconnected()), this,
+                         SLOT(disconnected()));
+
+        Client client;
+        client.subscribed = false;
+        client.subscriptionHash = 0;
+        client.head = 0;
+        client.pending = 0;
+        client.dropped = 0;
+        clients.insert(socket, client);
+        logBuffer.append(CLIENT_CONNECTED_TEXT.arg(clients.size()));
+    }
+}
+
+void FanoutServer::disconnected() {
+    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
+    if (!socket || !clients.contains(socket)) return;
+    logBuffer.append(CLIENT_DISCONNECTED_TEXT
+                     .arg(clients.value(socket).dropped));
+    clients.remove(socket);
+    socket->deleteLater();
+}
+
+void FanoutServer::messageReceived(QString message) {
+    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
+    QStringList names;
+    if (socket && Subscription::decode(message, JSON_SUBSCRIBE, names)) {
+        subscribe(socket, names);
+        return;
+    }
+    if (Subscription::isMessage(message, JSON_ECHO)) {
+        emit echoReceived(message);
+        return;
+    }
+    broadcast(message);
+}
+
+void FanoutServer::bytesWritten(qint64 bytes) {
+    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
+    auto i = clients.find(socket);
+    if (i == clients.end()) return;
+    i.value().pending = qMax(i.value().pending - bytes, qint64(0));
+    drain(socket, i.value());
+}
+
+void FanoutServer::sendCatalog() {
+    if (!catalogChanged) return;
+    catalogChanged = false;
+
+    Message message = textMessage(Subscription::encode(JSON_CATALOG,
+                                                       catalog));
+    for (auto i = clients.begin(); i != clients.end(); ++i) {
+        if (i.value().subscribed) enqueue(i.key(), i.value(), message);
+    }
+}
+
+void FanoutServer::subscribe(QWebSocket *socket, const QStringList &names) {
+    logBuffer.append(SUBSCRIBED_LOG_TEXT.arg(names.size()));
+    Client &client = clients[socket];
+    client.subscribed = !names.isEmpty();
+    client.subscription = QSet<QString>(names.begin(), names.end());
+    client.subscriptionHash = qHash(client.subscription);
+    for (auto i = clients.cbegin(); i != clients.cend(); ++i) {
+        if (i.key() != socket
+                && i.value().subscriptionHash == client.subscriptionHash
+                && i.value().subscription == client.subscription) {
+            client.subscription = i.value().subscription;
+            break;
+        }
+    }
+    if (client.subscribed) {
+        Message message = textMessage(Subscription::encode(JSON_CATALOG,
+                                                           catalog));
+        enqueue(socket, client, message);
+    }
+}
+
+void FanoutServer::addToCatalog() {
+    for (const Sample &sample : samples) {
+        if (sample.name == "" || sample.name == PROBE_NAME
+                || catalogNames.contains(sample.name)) continue;
+        catalogNames.insert(sample.name);
+        catalog << sample.name;
+        catalogChanged = true;
+    }
+}
+
+int FanoutServer::matchingSamples(const QSet<QString> &names,
+                                  QVector<Sample> &matching) {
+    matching.clear();
+    for (const Sample &sample : samples) {
+        if (names.contains(sample.name) || sample.name == PROBE_NAME) {
+            matching.append(sample);
+        }
+    }
+    return matching.size();
+}
+
+// Returns the samples of the current message matching a subscription,
+// encoded once per distinct subscription. Clients with equal subscriptions
+// share the set, so finding the cached result compares a pointer.
+FanoutServer::Filtered FanoutServer::filter(const Client &client,
+                                            bool isBinary) {
+    auto cached = filtered.constFind(client.subscriptionHash);
+    if (cached != filtered.constEnd()
+            && cached.value().subscription == client.subscription) {
+        return cached.value();
+    }
+
+    Filtered result;
+    result.subscription = client.subscription;
+    result.count = matchingSamples(client.subscription, matching);
+    if (result.count && result.count < samples.size() && isBinary) {
+        BinaryEncoder encoder;
+        for (const Sample &sample : matching) addSample(encoder, sample);
+        result.message = binaryMessage(encoder.finish());
+    }
+    else if (result.count && result.count < samples.size()) {
+        QJsonArray batch;
+        for (const Sample &sample : matching) {
+            QJsonObject object;
+            object.insert(JSON_NAME, sample.name);
+            object.insert(JSON_VALUE, sample.value);
+            if (sample.time != "") object.insert(JSON_TIME, sample.time);
+            batch.append(object);
+        }
+        result.message = textMessage(QString::fromUtf8(
+                    QJsonDocument(batch).toJson(QJsonDocument::Compact)));
+    }
+    if (result.count == 1) result.message.key = matching.first().name;
+    if (cached == filtered.constEnd()) {
+        filtered.insert(client.subscriptionHash, result);
+    }
+    return result;
+}
+
+// Sends at once while the socket keeps up, otherwise queues the message.
+// With LatestOnly a queued message of the same parameter is replaced.
+void FanoutServer::enqueue(QWebSocket *socket, Client &client,
+                           const Message &message) {
+    if (client.queue.isEmpty() && client.pending < CLIENT_BUFFER_MAX) {
+        send(socket, client, message);
+        return;
+    }
+
+    if (policy == LatestOnly && message.key != "") {
+        auto latest = client.latest.find(message.key);
+        if (latest != client.latest.end()) {
+            client.queue[int(latest.value() - client.head)] = message;
+            client.dropped++;
+            dropped++;
+            return;
+        }
+        client.latest.insert(message.key, client.head + client.queue.size());
+    }
+    if (client.queue.size() >= queueLimit) dropOldest(client);
+    client.queue.enqueue(message);
+}
+
+void FanoutServer::drain(QWebSocket *socket, Client &client) {
+    while (!client.queue.isEmpty() && client.pending < CLIENT_BUFFER_MAX) {
+        Message message = client.queue.dequeue();
+        if (message.key != "") {
+            auto latest = client.latest.find(message.key);
+            if (latest != client.latest.end()
+                    && latest.value() == client.head) {
+                client.latest.erase(latest);
+            }
+        }
+        client.head++;
+        send(socket, client, message);
+    }
+}
+
+void FanoutServer::send(QWebSocket *socket, Client &client,
+                        const Message &message) {
+    if (message.isBinary) socket->sendBinaryMessage(message.binary);
+    else socket->sendTextMessage(message.text);
+    client.pending += message.size;
+    bytesSent += message.size;
+}
+
+void FanoutServer::dropOldest(Client &client) {
+    const Message &oldest = client.queue.head();
+    if (oldest.key != "") {
+        auto latest = client.latest.find(oldest.key);
+        if (latest != client.latest.end() && latest.value() == client.head) {
+            client.latest.erase(latest);
+        }
+    }
+    client.queue.dequeue();
+    client.head++;
+    client.dropped++;
+    dropped++;
+}
+
+FanoutServer::Message FanoutServer::textMessage(const QString &text) {
+    Message message;
+    message.text = text;
+    message.isBinary = false;
+    message.size = utf8Size(text);
+    return message;
+}
+
+FanoutServer::Message FanoutServer::binaryMessage(const QByteArray &binary) {
+    Message message;
+    message.binary = binary;
+    message.isBinary = true;
+    message.size = binary.size();
+    return message;
+}
+
+// Counts the UTF-8 bytes of a text without converting it
+qint64 FanoutServer::utf8Size(const QString &text) {
+    qint64 size = 0;
+    for (QChar c : text) {
+        ushort unicode = c.unicode();
+        if (unicode < 0x80) size += 1;
+        else if (unicode < 0x800 || c.isSurrogate()) size += 2;
+        else size += 3;
+    }
+    return size;
+}
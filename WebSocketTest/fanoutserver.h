@@ -0,0 +1,132 @@
+#ifndef FANOUTSERVER_H
+#define FANOUTSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QQueue>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QtWebSockets/QtWebSockets>
+#include "messagedecoder.h"
+#include "binaryprotocol.h"
+#include "subscription.h"
+#include "logbuffer.h"
+
+const int CATALOG_INTERVAL = 5000;
+const QString TIME_FORMAT = "yyyy/MM/dd - hh:mm:ss";
+const int CLIENT_QUEUE_MAX = 1024;
+const qint64 CLIENT_BUFFER_MAX = 256 * 1024;
+
+const QString FANOUT_NAME = "WebSocketTest";
+const QString TEXT_LOG_TEXT = "> ";
+const QString BINARY_LOG_TEXT = "> binary message, %1 bytes";
+const QString SUBSCRIBED_LOG_TEXT = "> client subscribed to %1 parameters";
+const QString CLIENT_CONNECTED_TEXT = "> client connected, %1 clients";
+const QString CLIENT_DISCONNECTED_TEXT = "> client disconnected, %1 dropped";
+const QString STATS_TEXT = "Clients: %1, sent %2 bytes, saved %3 bytes"
+                           " by subscriptions, dropped %4 messages";
+const QString DROP_OLDEST_POLICY = "drop-oldest";
+const QString LATEST_ONLY_POLICY = "latest-only";
+
+// Sends each message to all clients. Messages are decoded once and filtered
+// once per distinct subscription, and the message is shared by every client
+// receiving it. Binary buffers are sent as they are, text messages are
+// converted to UTF-8 by QWebSocket for each client, as it only sends text
+// from a QString. Clients that do not keep up get their messages queued up
+// to a limit, after which the policy decides what is dropped.
+class FanoutServer : public QObject {
+    Q_OBJECT
+
+public:
+    enum DropPolicy {
+        DropOldest, // Drops the oldest queued message
+        LatestOnly  // Keeps only the newest message of each parameter
+    };
+
+    explicit FanoutServer(QObject *parent = 0);
+
+    bool listen(quint16 port);
+    void close();
+    quint16 port() const;
+    void setPolicy(DropPolicy policy);
+    void setQueueLimit(int limit);
+    int clientCount() const;
+    QString statistics() const;
+    LogBuffer &log();
+
+    static bool parsePolicy(const QString &text, DropPolicy &policy);
+    static void addSample(BinaryEncoder &encoder, const Sample &sample);
+
+signals:
+    void echoReceived(QString message);
+
+public slots:
+    void broadcast(const QString &message);
+    void broadcastBinary(const QByteArray &message);
+
+private slots:
+    void connected();
+    void disconnected();
+    void messageReceived(QString message);
+    void bytesWritten(qint64 bytes);
+    void sendCatalog();
+
+private:
+    struct Message {
+        QString text;
+        QByteArray binary;
+        bool isBinary;
+        QString key;
+        qint64 size;
+    };
+
+    struct Client {
+        bool subscribed;
+        QSet<QString> subscription;
+        uint subscriptionHash;
+        QQueue<Message> queue;
+        QHash<QString, quint64> latest;
+        quint64 head;
+        qint64 pending;
+        quint64 dropped;
+    };
+
+    struct Filtered {
+        QSet<QString> subscription;
+        int count;
+        Message message;
+    };
+
+    void subscribe(QWebSocket *socket, const QStringList &names);
+    void addToCatalog();
+    int matchingSamples(const QSet<QString> &names, QVector<Sample> &matching);
+    Filtered filter(const Client &client, bool isBinary);
+    void enqueue(QWebSocket *socket, Client &client, const Message &message);
+    void drain(QWebSocket *socket, Client &client);
+    void send(QWebSocket *socket, Client &client, const Message &message);
+    void dropOldest(Client &client);
+    Message textMessage(const QString &text);
+    Message binaryMessage(const QByteArray &binary);
+    static qint64 utf8Size(const QString &text);
+
+    QWebSocketServer *server;
+    QHash<QWebSocket*, Client> clients;
+    DropPolicy policy;
+    int queueLimit;
+    QStringList catalog;
+    QSet<QString> catalogNames;
+    bool catalogChanged;
+    quint64 bytesSent;
+    quint64 bytesSaved;
+    quint64 dropped;
+    MessageDecoder decoder;
+    BinaryDecoder binaryDecoder;
+    QVector<Sample> samples;
+    QVector<Sample> matching;
+    QHash<uint, Filtered> filtered;
+    LogBuffer logBuffer;
+};
+
+#endif // FANOUTSERVER_H
@@ -0,0 +1,121 @@
+#include "loadgenerator.h"
+#include <algorithm>
+
+LoadGenerator::LoadGenerator(FanoutServer *server,
+                             const LoadSettings &settings, QTextStream &out,
+                             QObject *parent)
+    : QObject(parent), server(server), settings(settings), out(out),
+      epoch(0), lastTick(0), activeTime(0), lastProbe(0), sent(0),
+      reportedMessages(0), samples(0), reportedSamples(0), nextParameter(0) {
+
+    this->settings.parameters = qMax(this->settings.parameters, 1);
+    this->settings.batch = qMax(this->settings.batch, 1);
+    this->settings.valueSizeMin = qMax(this->settings.valueSizeMin, 1);
+    this->settings.valueSizeMax = qMax(this->settings.valueSizeMax,
+                                       this->settings.valueSizeMin);
+
+    tickTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&tickTimer, SIGNAL(timeout()), this, SLOT(tick()));
+    QObject::connect(&reportTimer, SIGNAL(timeout()), this, SLOT(report()));
+    QObject::connect(server, SIGNAL(echoReceived(QString)), this,
+                     SLOT(echoReceived(QString)));
+}
+
+void LoadGenerator::start() {
+    epoch = QDateTime::currentMSecsSinceEpoch() * 1000;
+    clock.start();
+    tickTimer.start(LOAD_TICK);
+    reportTimer.start(LOAD_REPORT_INTERVAL);
+}
+
+// Sends the messages due since the previous tick. The rate applies to the
+// time spent in bursts, so pauses do not cause catch-up bursts later.
+void LoadGenerator::tick() {
+    qint64 elapsed = clock.elapsed();
+    qint64 delta = elapsed - lastTick;
+    lastTick = elapsed;
+
+    if (settings.duration > 0 && elapsed >= settings.duration * 1000LL) {
+        tickTimer.stop();
+        report();
+        emit finished();
+        return;
+    }
+
+    int period = settings.burstOn + settings.burstOff;
+    if (settings.burstOn > 0 && elapsed % period >= settings.burstOn) return;
+    activeTime += delta;
+
+    qint64 due = activeTime * settings.rate / 1000 - qint64(sent);
+    due = qMin(due, qint64(settings.rate));
+    for (qint64 i = 0; i < due; i++) {
+        bool probe = elapsed - lastProbe >= settings.probeInterval;
+        if (probe) lastProbe = elapsed;
+        server->broadcast(message(probe));
+        sent++;
+    }
+}
+
+void LoadGenerator::report() {
+    out << LOAD_REPORT_TEXT.arg(sent - reportedMessages)
+                           .arg(samples - reportedSamples) << "\n";
+    reportedMessages = sent;
+    reportedSamples = samples;
+    printLatency(ROUND_TRIP_TEXT, roundTrips);
+    printLatency(DISPLAY_TEXT, displayLatencies);
+    out.flush();
+}
+
+void LoadGenerator::echoReceived(QString message) {
+    qint64 displayed;
+    if (!Subscription::decodeEcho(message, echoed, displayed)) return;
+    qint64 received = now();
+    for (qint64 time : echoed) {
+        roundTrips.append(received - time);
+        displayLatencies.append(displayed - time);
+    }
+}
+
+QString LoadGenerator::message(bool probe) {
+    QStringList objects;
+    for (int i = 0; i < settings.batch; i++) {
+        objects << "{\"name\":\"" + LOAD_NAME_PREFIX
+                   + QString::number(nextParameter)
+                   + "\",\"value\":\"" + value() + "\"}";
+        nextParameter = (nextParameter + 1) % settings.parameters;
+    }
+    samples += settings.batch;
+    if (probe) {
+        objects << "{\"name\":\"" + PROBE_NAME + "\",\"value\":\""
+                   + QString::number(now()) + "\"}";
+    }
+    if (objects.size() == 1) return objects.first();
+    return "[" + objects.join(",") + "]";
+}
+
+// Returns a number padded or cut to a size drawn uniformly
+// between the shortest and the longest value size
+QString LoadGenerator::value() {
+    QRandomGenerator *random = QRandomGenerator::global();
+    int size = settings.valueSizeMin + random->bounded(
+                settings.valueSizeMax - settings.valueSizeMin + 1);
+    return QString::number(random->generateDouble() * 1000, 'f', 6)
+                                            .leftJustified(size, '0', true);
+}
+
+qint64 LoadGenerator::now() const {
+    return epoch + clock.nsecsElapsed() / 1000;
+}
+
+void LoadGenerator::printLatency(const QString &label,
+                                 QVector<qint64> &values) {
+    if (values.isEmpty()) return;
+    std::sort(values.begin(), values.end());
+    auto at = [&values](double share) {
+        return values.at(qMin(int(values.size() * share), values.size() - 1));
+    };
+    out << LATENCY_TEXT.arg(label).arg(values.size()).arg(at(0.5))
+                       .arg(at(0.9)).arg(at(0.99)).arg(at(0.999))
+                       .arg(values.last()) << "\n";
+    values.clear();
+}
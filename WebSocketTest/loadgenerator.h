@@ -0,0 +1,79 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <QRandomGenerator>
+#include "fanoutserver.h"
+
+const int LOAD_TICK = 5;
+const int LOAD_REPORT_INTERVAL = 1000;
+const QString LOAD_NAME_PREFIX = "P";
+const QString LOAD_REPORT_TEXT = "Sent %1 messages/s, %2 samples/s";
+const QString LATENCY_TEXT = "%1 latency us: n %2, p50 %3, p90 %4, p99 %5,"
+                             " p99.9 %6, max %7";
+const QString ROUND_TRIP_TEXT = "Round-trip";
+const QString DISPLAY_TEXT = "Display";
+
+// Traffic shape of the load generator
+struct LoadSettings {
+    int rate = 100;             // Messages per second during a burst
+    int parameters = 100;       // Number of distinct parameter names
+    int valueSizeMin = 8;       // Shortest value in characters
+    int valueSizeMax = 8;       // Longest value in characters
+    int batch = 1;              // Samples per message
+    int burstOn = 0;            // Burst length in ms, 0 for continuous load
+    int burstOff = 0;           // Pause between bursts in ms
+    int probeInterval = 100;    // Time between latency probes in ms
+    int duration = 0;           // Run time in seconds, 0 to run until killed
+};
+
+// Sends generated messages through a fan-out server. Messages carry latency
+// probes whose echoes from MonitorScreen are reported as percentiles.
+class LoadGenerator : public QObject {
+    Q_OBJECT
+
+public:
+    LoadGenerator(FanoutServer *server, const LoadSettings &settings,
+                  QTextStream &out, QObject *parent = 0);
+
+    void start();
+
+signals:
+    void finished();
+
+private slots:
+    void tick();
+    void report();
+    void echoReceived(QString message);
+
+private:
+    QString message(bool probe);
+    QString value();
+    qint64 now() const;
+    void printLatency(const QString &label, QVector<qint64> &values);
+
+    FanoutServer *server;
+    LoadSettings settings;
+    QTextStream &out;
+    QTimer tickTimer;
+    QTimer reportTimer;
+    QElapsedTimer clock;
+    qint64 epoch;
+    qint64 lastTick;
+    qint64 activeTime;
+    qint64 lastProbe;
+    quint64 sent;
+    quint64 reportedMessages;
+    quint64 samples;
+    quint64 reportedSamples;
+    int nextParameter;
+    QVector<qint64> roundTrips;
+    QVector<qint64> displayLatencies;
+    QVector<qint64> echoed;
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,50 @@
+#include "logbuffer.h"
+
+LogBuffer::LogBuffer(int capacity, int rate)
+    : lines(qMax(capacity, 1)), first(0), count(0), rate(rate), inWindow(0),
+      suppressed(0), overwritten(0) {
+    window.start();
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(LOG_INTERVAL);
+}
+
+void LogBuffer::append(const QString &line) {
+    if (!flushTimer.isActive()) flushTimer.start();
+    if (window.elapsed() >= 1000) {
+        window.restart();
+        inWindow = 0;
+    }
+    if (inWindow >= rate) {
+        suppressed++;
+        return;
+    }
+    inWindow++;
+
+    if (count == lines.size()) {
+        first = (first + 1) % lines.size();
+        count--;
+        overwritten++;
+    }
+    lines[(first + count) % lines.size()] = line;
+    count++;
+}
+
+QStringList LogBuffer::take() {
+    QStringList taken;
+    if (overwritten) taken << LOG_OVERWRITTEN_TEXT.arg(overwritten);
+    for (int i = 0; i < count; i++) {
+        QString &line = lines[(first + i) % lines.size()];
+        taken << line;
+        line.clear();
+    }
+    if (suppressed) taken << LOG_SUPPRESSED_TEXT.arg(suppressed);
+    first = 0;
+    count = 0;
+    suppressed = 0;
+    overwritten = 0;
+    return taken;
+}
+
+QTimer *LogBuffer::timer() {
+    return &flushTimer;
+}
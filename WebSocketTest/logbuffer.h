@@ -0,0 +1,40 @@
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+
+const int LOG_CAPACITY = 1000;
+const int LOG_INTERVAL = 250;
+const int LOG_RATE = 20;
+const QString LOG_SUPPRESSED_TEXT = "> %1 lines suppressed";
+const QString LOG_OVERWRITTEN_TEXT = "> %1 lines overwritten";
+
+// Keeps the newest log lines in a fixed ring. At most LOG_RATE lines per
+// second are kept, the rest are only counted. Appending arms a single-shot
+// timer that fires LOG_INTERVAL later, so an idle log causes no wakeups.
+class LogBuffer {
+
+public:
+    explicit LogBuffer(int capacity = LOG_CAPACITY, int rate = LOG_RATE);
+
+    void append(const QString &line);
+    QStringList take();
+    QTimer *timer();
+
+private:
+    QVector<QString> lines;
+    int first;
+    int count;
+    int rate;
+    int inWindow;
+    quint64 suppressed;
+    quint64 overwritten;
+    QElapsedTimer window;
+    QTimer flushTimer;
+};
+
+#endif // LOGBUFFER_H
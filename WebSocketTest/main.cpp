@@ -1,9 +1,119 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
 #include "websockettest.h"
 
+static bool parseRange(const QString &text, int &first, int &second) {
+    QStringList parts = text.split(':');
+    bool validFirst, validSecond = true;
+    first = parts.first().toInt(&validFirst);
+    second = parts.size() > 1 ? parts.at(1).toInt(&validSecond) : first;
+    return parts.size() <= 2 && validFirst && validSecond && first >= 0
+                                                          && second >= 0;
+}
+
+static void addOption(QCommandLineParser &parser, const QString &name,
+                      const QString &help, const QString &defaultValue) {
+    parser.addOption(QCommandLineOption(name, help, name, defaultValue));
+}
+
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    WebSocketTest window;
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+        QString argument(argv[i]);
+        if (argument == "--" + HEADLESS_OPTION
+                || argument == "--" + LOAD_OPTION) headless = true;
+    }
+    QScopedPointer<QCoreApplication> app(headless
+        ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+    QCoreApplication::setApplicationName(APP_NAME);
+
+    LoadSettings load;
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption(HEADLESS_OPTION, HEADLESS_HELP));
+    parser.addOption(QCommandLineOption(LOAD_OPTION, LOAD_HELP));
+    addOption(parser, PORT_OPTION, PORT_HELP, QString::number(PORT));
+    addOption(parser, POLICY_OPTION, POLICY_HELP, DROP_OLDEST_POLICY);
+    addOption(parser, QUEUE_OPTION, QUEUE_HELP,
+              QString::number(CLIENT_QUEUE_MAX));
+    addOption(parser, RATE_OPTION, RATE_HELP, QString::number(load.rate));
+    addOption(parser, PARAMETERS_OPTION, PARAMETERS_HELP,
+              QString::number(load.parameters));
+    addOption(parser, VALUE_SIZE_OPTION, VALUE_SIZE_HELP,
+              QString::number(load.valueSizeMin) + ":"
+              + QString::number(load.valueSizeMax));
+    addOption(parser, BATCH_OPTION, BATCH_HELP, QString::number(load.batch));
+    addOption(parser, BURST_OPTION, BURST_HELP, "0:0");
+    addOption(parser, PROBE_OPTION, PROBE_HELP,
+              QString::number(load.probeInterval));
+    addOption(parser, DURATION_OPTION, DURATION_HELP,
+              QString::number(load.duration));
+    parser.process(*app);
+
+    QTextStream out(stdout);
+    FanoutServer server;
+    FanoutServer::DropPolicy policy;
+    QString invalid;
+    bool valid;
+
+    quint16 port = parser.value(PORT_OPTION).toUShort(&valid);
+    if (!valid) invalid = PORT_OPTION;
+    int queue = parser.value(QUEUE_OPTION).toInt(&valid);
+    if (!valid) invalid = QUEUE_OPTION;
+    if (!FanoutServer::parsePolicy(parser.value(POLICY_OPTION), policy)) {
+        invalid = POLICY_OPTION;
+    }
+    load.rate = parser.value(RATE_OPTION).toInt(&valid);
+    if (!valid || load.rate < 0) invalid = RATE_OPTION;
+    load.parameters = parser.value(PARAMETERS_OPTION).toInt(&valid);
+    if (!valid) invalid = PARAMETERS_OPTION;
+    load.batch = parser.value(BATCH_OPTION).toInt(&valid);
+    if (!valid) invalid = BATCH_OPTION;
+    load.probeInterval = parser.value(PROBE_OPTION).toInt(&valid);
+    if (!valid) invalid = PROBE_OPTION;
+    load.duration = parser.value(DURATION_OPTION).toInt(&valid);
+    if (!valid) invalid = DURATION_OPTION;
+    if (!parseRange(parser.value(VALUE_SIZE_OPTION), load.valueSizeMin,
+                    load.valueSizeMax)) invalid = VALUE_SIZE_OPTION;
+    if (!parseRange(parser.value(BURST_OPTION), load.burstOn,
+                    load.burstOff)) invalid = BURST_OPTION;
+
+    if (invalid != "") {
+        out << INVALID_OPTION_TEXT.arg(invalid) << "\n";
+        return 1;
+    }
+    server.setPolicy(policy);
+    server.setQueueLimit(queue);
+
+    if (!server.listen(port)) {
+        out << LISTEN_FAILED_TEXT.arg(port) << "\n";
+        if (headless) return 1;
+    }
+
+    if (headless) {
+        out << SERVER_LISTENING_TEXT << port << "\n";
+        out.flush();
+        QTimer timer;
+        QObject::connect(&timer, &QTimer::timeout, [&server, &out]() {
+            for (const QString &line : server.log().take()) {
+                out << line << "\n";
+            }
+            out << server.statistics() << "\n";
+            out.flush();
+        });
+        timer.start(LOG_INTERVAL * 4);
+
+        LoadGenerator generator(&server, load, out);
+        if (parser.isSet(LOAD_OPTION)) {
+            QObject::connect(&generator, SIGNAL(finished()), app.data(),
+                             SLOT(quit()));
+            generator.start();
+        }
+        return app->exec();
+    }
+
+    WebSocketTest window(&server);
     window.show();
-    return app.exec();
+    return app->exec();
 }
@@ -1,29 +1,28 @@
 #include "websockettest.h"
 #include "ui_websockettest.h"
 
-WebSocketTest::WebSocketTest(QWidget *parent) :
-    QMainWindow(parent), server(new QWebSocketServer(APP_NAME,
-        QWebSocketServer::NonSecureMode, this)), ui(new Ui::WebSocketTest) {
+WebSocketTest::WebSocketTest(FanoutServer *server, QWidget *parent) :
+    QMainWindow(parent), ui(new Ui::WebSocketTest), server(server) {
 
     ui->setupUi(this);
     textBrowser = ui->textBrowser;
+    textBrowser->document()->setMaximumBlockCount(LOG_BLOCKS_MAX);
     textEdit = ui->textEdit;
     QShortcut *shortcut = new QShortcut(QKeySequence(SEND_SHORTCUT), this);
     QObject::connect(shortcut, SIGNAL(activated()), this, SLOT(sendMessage()));
+    shortcut = new QShortcut(QKeySequence(BATCH_SHORTCUT), this);
+    QObject::connect(shortcut, SIGNAL(activated()), this, SLOT(sendBatch()));
+    shortcut = new QShortcut(QKeySequence(BINARY_SHORTCUT), this);
+    QObject::connect(shortcut, SIGNAL(activated()), this, SLOT(sendBinary()));
     shortcut = new QShortcut(QKeySequence(PREV_SHORTCUT), this);
     QObject::connect(shortcut, SIGNAL(activated()), this, SLOT(prevMessage()));
 
-    if (server->listen(QHostAddress::Any, PORT)) {
-        textBrowser->append(SERVER_LISTENING_TEXT + QString::number(PORT)
-                                                                + INFO_TEXT);
-
-        QObject::connect(server, SIGNAL(newConnection()), this,
-                         SLOT(connected()));
-        QObject::connect(server, SIGNAL(closed()), this, SLOT(disconnected()));
+    if (server->port()) {
+        textBrowser->append(SERVER_LISTENING_TEXT
+                            + QString::number(server->port()) + INFO_TEXT);
     }
-    QTimer *timer = new QTimer;
-    QObject::connect(timer, SIGNAL(timeout()), this, SLOT(update()));
-    timer->start(TICK_LENGTH);
+    QObject::connect(server->log().timer(), SIGNAL(timeout()), this,
+                     SLOT(showLog()));
 }
 
 WebSocketTest::~WebSocketTest() {
@@ -31,20 +30,12 @@ WebSocketTest::~WebSocketTest() {
     delete ui;
 }
 
-void WebSocketTest::connected() {
-    QWebSocket *socket = server->nextPendingConnection();
-    QObject::connect(socket, SIGNAL(textMessageReceived(QString)), this,
-                     SLOT(messageReceived(QString)));
-    QObject::connect(socket, SIGNAL(disconnected()), this,
-                     SLOT(disconnected()));
-    clients << socket;
+void WebSocketTest::messageReceived(QString message) {
+    server->broadcast(message);
 }
 
-void WebSocketTest::messageReceived(QString message) {
-    for (QWebSocket* client : clients) {
-        client->sendTextMessage(message);
-    }
-    textBrowser->append("> " + message);
+void WebSocketTest::binaryMessageReceived(QByteArray message) {
+    server->broadcastBinary(message);
 }
 
 void WebSocketTest::sendMessage() {
@@ -53,14 +44,37 @@ void WebSocketTest::sendMessage() {
     textEdit->clear();
 }
 
+void WebSocketTest::sendBatch() {
+    prevText = textEdit->toPlainText();
+    QStringList lines;
+    for (const QString &line : prevText.split('\n')) {
+        if (!line.trimmed().isEmpty()) lines << line.trimmed();
+    }
+    messageReceived("[" + lines.join(",") + "]");
+    textEdit->clear();
+}
+
+void WebSocketTest::sendBinary() {
+    prevText = textEdit->toPlainText();
+    QVector<Sample> samples;
+    MessageDecoder decoder;
+    decoder.decode(prevText, samples);
+    BinaryEncoder encoder;
+    for (const Sample &sample : samples) {
+        FanoutServer::addSample(encoder, sample);
+    }
+    binaryMessageReceived(encoder.finish());
+    textEdit->clear();
+}
+
 void WebSocketTest::prevMessage() {
     textEdit->setText(prevText);
 }
 
-void WebSocketTest::disconnected() {
-    QWebSocket *client = qobject_cast<QWebSocket*>(sender());
-    clients.removeAll(client);
-    client->deleteLater();
+void WebSocketTest::showLog() {
+    statusBar()->showMessage(server->statistics());
+    QStringList lines = server->log().take();
+    if (!lines.isEmpty()) textBrowser->append(lines.join('\n'));
 }
 
 void WebSocketTest::on_actionExit_triggered(){
@@ -73,7 +87,20 @@ void WebSocketTest::on_actionTest_Message_triggered() {
     messageReceived(TEST_MESSAGE);
 }
 
-void WebSocketTest::update() {
+void WebSocketTest::on_actionTest_Batch_triggered() {
+    prevText = TEST_BATCH_MESSAGE;
+    messageReceived(TEST_BATCH_MESSAGE);
+}
+
+void WebSocketTest::on_actionTest_Binary_triggered() {
+    BinaryEncoder encoder;
+    encoder.addDouble("Vin", 14.257, "V",
+                      QDateTime::currentMSecsSinceEpoch() * 1000);
+    binaryMessageReceived(encoder.finish());
+}
+
+void WebSocketTest::resizeEvent(QResizeEvent *event) {
+    QMainWindow::resizeEvent(event);
     textBrowser->resize(this->width(), this->height() / BROWSER_RATIO -
                                                             HEIGHT_OFFSET);
     textEdit->move(0, this->height() / BROWSER_RATIO - HEIGHT_OFFSET);
@@ -9,48 +9,97 @@
 #include <QKeyEvent>
 #include <QtWebSockets/QtWebSockets>
 #include "ui_websockettest.h"
+#include "messagedecoder.h"
+#include "binaryprotocol.h"
+#include "fanoutserver.h"
+#include "loadgenerator.h"
 
 const short PORT = 1234;
-const short TICK_LENGTH = 10;
 const short HEIGHT_OFFSET = 10;
+const int LOG_BLOCKS_MAX = 1000;
 const float BROWSER_RATIO = 1.5f;
 
 const QString APP_NAME = "WebSocketTest";
 const QString SEND_SHORTCUT = "Ctrl+Return";
+const QString BATCH_SHORTCUT = "Ctrl+Shift+Return";
+const QString BINARY_SHORTCUT = "Ctrl+Alt+Return";
 const QString PREV_SHORTCUT = "Ctrl+Up";
 const QString EXIT_CONFIRM_TEXT = "Are you sure you want to quit?";
 const QString SERVER_LISTENING_TEXT = "Server listening on port ";
 const QString INFO_TEXT = "\n\nPress Ctrl + Enter to send messages"
+                          "\nPress Ctrl + Shift + Enter to send each line"
+                          " as one batch"
+                          "\nPress Ctrl + Alt + Enter to send as binary"
                           "\nPress Ctrl + T to send a test message"
+                          "\nPress Ctrl + B to send a test batch"
+                          "\nPress Ctrl + Shift + T to send a binary test"
                           "\nPress Ctrl + Up to edit previous message\n";
+const QString HEADLESS_OPTION = "headless";
+const QString HEADLESS_HELP = "Run as a fan-out relay without a window";
+const QString PORT_OPTION = "port";
+const QString PORT_HELP = "Port to listen on";
+const QString POLICY_OPTION = "policy";
+const QString POLICY_HELP = "Queue policy for slow clients:"
+                            " drop-oldest or latest-only";
+const QString QUEUE_OPTION = "queue";
+const QString QUEUE_HELP = "Maximum number of queued messages per client";
+const QString LOAD_OPTION = "load";
+const QString LOAD_HELP = "Generate load and report latency, implies"
+                          " --headless";
+const QString RATE_OPTION = "rate";
+const QString RATE_HELP = "Messages per second during a burst";
+const QString PARAMETERS_OPTION = "parameters";
+const QString PARAMETERS_HELP = "Number of generated parameters";
+const QString VALUE_SIZE_OPTION = "value-size";
+const QString VALUE_SIZE_HELP = "Value length in characters, drawn uniformly"
+                                " from min:max";
+const QString BATCH_OPTION = "batch";
+const QString BATCH_HELP = "Samples per message";
+const QString BURST_OPTION = "burst";
+const QString BURST_HELP = "Burst pattern on:off in ms, continuous if not set";
+const QString PROBE_OPTION = "probe";
+const QString PROBE_HELP = "Time between latency probes in ms";
+const QString DURATION_OPTION = "duration";
+const QString DURATION_HELP = "Load duration in seconds, 0 to run until"
+                              " killed";
+const QString INVALID_OPTION_TEXT = "Invalid value for --%1";
+const QString LISTEN_FAILED_TEXT = "Cannot listen on port %1";
 const QString TEST_MESSAGE =
 "{\"name\":\"Vin\",\"value\":\"14.257 V\",\"time\":\"2017/09/02 - 01:18:30\"}";
+const QString TEST_BATCH_MESSAGE =
+"{\"time\":\"2017/09/02 - 01:18:30\",\"values\":{\"Vin\":\"14.257 V\","
+"\"Iout\":\"1.203 A\",\"Temp\":\"41.5 C\"}}";
 
 class Ui::WebSocketTest;
 class WebSocketTest : public QMainWindow {
     Q_OBJECT
 
 public:
-    explicit WebSocketTest(QWidget *parent = 0);
+    explicit WebSocketTest(FanoutServer *server, QWidget *parent = 0);
     ~WebSocketTest();
 
+protected:
+    void resizeEvent(QResizeEvent *event);
+
 private slots:
-    void connected();
     void messageReceived(QString message);
+    void binaryMessageReceived(QByteArray message);
     void sendMessage();
+    void sendBatch();
+    void sendBinary();
     void prevMessage();
-    void disconnected();
+    void showLog();
     void on_actionExit_triggered();
     void on_actionTest_Message_triggered();
-    void update();
+    void on_actionTest_Batch_triggered();
+    void on_actionTest_Binary_triggered();
 
 private:
     Ui::WebSocketTest *ui;
     QTextEdit *textEdit;
     QTextBrowser *textBrowser;
     QString prevText;
-    QWebSocketServer *server;
-    QList<QWebSocket*> clients;
+    FanoutServer *server;
 };
 
 #endif // WEBSOCKETTEST_H
@@ -0,0 +1,11 @@
+/*!
+ * \file allocationcounter.h
+ */
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+quint64 allocationCount();
+
+#endif // ALLOCATIONCOUNTER_H
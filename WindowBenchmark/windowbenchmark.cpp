@@ -0,0 +1,300 @@
+/*!
+ * \file windowbenchmark.cpp
+ */
+#include <QtTest>
+#include "monitorwindow.h"
+#include "allocationcounter.h"
+
+const int BENCHMARK_MESSAGES = 100000; /*!< Messages sent per scenario */
+const int LIST_PARAMETERS = 10000; /*!< New parameters in the list scenario */
+const int RESIZE_COUNT = 2000; /*!< Window resizes in the resize scenario */
+const int FRAME_MESSAGES = 100; /*!< Messages applied between two frames */
+const int VALUE_VARIANTS = 64; /*!< Distinct values sent per scenario */
+const int ALARM_RULES = 100; /*!< Parameters with an alarm rule */
+const QString ALARM_CONDITION = ">= 70 V"; /*!< Alarm rule of the
+                        parameters, raised by some of the sent values */
+const QSize RESIZE_SMALL(640, 480); /*!< Window size in the resize storm */
+const QSize RESIZE_LARGE(1280, 720); /*!< Window size in the resize storm */
+const QString BENCHMARK_ORGANIZATION = "MonitorScreenBenchmark";
+/*!< QSettings organization, keeps the user configuration untouched */
+const QString OTHER_PARAMETER = "Other"; /*!< Selected parameter that
+                                              is never updated */
+const QString MESSAGE_FORMAT = "{\"name\":\"P%1\",\"value\":\"%2 V\"}";
+/*!< Benchmarked message */
+const char JSON_OUTPUT_VARIABLE[] = "WINDOW_BENCHMARK_JSON";
+/*!< Environment variable overriding the result file */
+const QString JSON_OUTPUT = "windowbenchmark.json"; /*!< Result file */
+
+/*!
+ * \brief Benchmarks for the ingest and render path of MonitorWindow
+ *
+ * Runs on the offscreen platform. Each scenario reports nanoseconds per
+ * message as its QtTest result, so -o result.csv,csv works as for the
+ * decoder benchmark. Messages per second and allocations per message
+ * are written with it as JSON to \b JSON_OUTPUT or the file named by
+ * \b JSON_OUTPUT_VARIABLE, for comparing runs between commits.
+ */
+class WindowBenchmark : public QObject {
+    Q_OBJECT
+
+private:
+    QVector<QString> messages(int parameters, int first = 0);
+    void apply(MonitorWindow &window, const QString &message);
+    void render(MonitorWindow &window);
+    void record(int count, qint64 nanoseconds, quint64 allocations);
+
+    MessageDecoder decoder; /*!< Decodes the messages as the worker does */
+    QVector<Sample> samples; /*!< Reused for decoded samples */
+    QJsonArray results; /*!< Results written at the end */
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void ingest_data();
+    void ingest();
+    void parameterList();
+    void resizeStorm_data();
+    void resizeStorm();
+    void resizeText();
+    void processText();
+};
+
+/*!
+ * \brief Builds messages cycling over parameters and values
+ *
+ * \param parameters: Number of distinct parameters
+ * \param first: Number of the first parameter
+ */
+QVector<QString> WindowBenchmark::messages(int parameters, int first) {
+    QVector<QString> built;
+    int count = qMax(parameters, VALUE_VARIANTS);
+    built.reserve(count);
+    for (int i = 0; i < count; i++) {
+        built << MESSAGE_FORMAT.arg(first + i % parameters)
+                               .arg(12.345 + i % VALUE_VARIANTS);
+    }
+    return built;
+}
+
+/*!
+ * \brief Decodes a message and applies its samples as the window
+ * does when draining the ingestion queue
+ */
+void WindowBenchmark::apply(MonitorWindow &window, const QString &message) {
+    samples.clear();
+    decoder.decode(message, samples);
+    qint64 received = QDateTime::currentMSecsSinceEpoch() * 1000;
+    for (Sample &sample : samples) {
+        sample.received = received;
+        window.applySample(sample);
+    }
+}
+
+/*!
+ * \brief Renders the pending frame and paints the changed widgets
+ */
+void WindowBenchmark::render(MonitorWindow &window) {
+    QMetaObject::invokeMethod(&window, "renderFrame", Qt::DirectConnection);
+    QCoreApplication::processEvents();
+}
+
+/*!
+ * \brief Reports the result of the current scenario
+ *
+ * \param count: Number of messages or events
+ * \param nanoseconds: Time taken by all of them
+ * \param allocations: Heap allocations made by all of them
+ */
+void WindowBenchmark::record(int count, qint64 nanoseconds,
+                             quint64 allocations) {
+    double perMessage = double(nanoseconds) / count;
+    QTest::setBenchmarkResult(perMessage, QTest::WalltimeNanoseconds);
+
+    QString name = QTest::currentTestFunction();
+    if (QTest::currentDataTag()) {
+        name += QString(":") + QTest::currentDataTag();
+    }
+    QJsonObject result;
+    result.insert("name", name);
+    result.insert("count", count);
+    result.insert("nsPerMessage", perMessage);
+    result.insert("messagesPerSecond", perMessage > 0 ? 1e9 / perMessage : 0);
+    result.insert("allocationsPerMessage", double(allocations) / count);
+    results.append(result);
+}
+
+void WindowBenchmark::initTestCase() {
+    QCoreApplication::setOrganizationName(BENCHMARK_ORGANIZATION);
+    QCoreApplication::setApplicationName(APP_NAME);
+    QSettings settings;
+    settings.clear();
+    settings.setValue(SNAPSHOT_FILE_SETTING, "");
+}
+
+/*!
+ * \brief Writes the results as JSON
+ */
+void WindowBenchmark::cleanupTestCase() {
+    QString path = qEnvironmentVariable(JSON_OUTPUT_VARIABLE, JSON_OUTPUT);
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QJsonObject root;
+    root.insert("benchmark", "WindowBenchmark");
+    root.insert("results", results);
+    file.write(QJsonDocument(root).toJson());
+    QSettings().clear();
+}
+
+void WindowBenchmark::ingest_data() {
+    QTest::addColumn<int>("parameters");
+    QTest::addColumn<bool>("selected");
+    QTest::addColumn<bool>("alarms");
+    QTest::newRow("1 parameter, selected") << 1 << true << false;
+    QTest::newRow("1 parameter, unselected") << 1 << false << false;
+    QTest::newRow("10k parameters, selected") << 10000 << true << false;
+    QTest::newRow("10k parameters, unselected") << 10000 << false << false;
+    QTest::newRow("1 parameter, selected, alarms") << 1 << true << true;
+    QTest::newRow("10k parameters, selected, alarms") << 10000 << true
+                                                      << true;
+}
+
+/*!
+ * \brief Messages of known parameters, decoded and applied
+ *
+ * A frame is rendered every \b FRAME_MESSAGES messages. Selected means
+ * that the stream contains the selected parameter, unselected that
+ * a parameter outside the stream is selected. With alarms the first
+ * \b ALARM_RULES parameters have a rule evaluated on each of their values.
+ */
+void WindowBenchmark::ingest() {
+    QFETCH(int, parameters);
+    QFETCH(bool, selected);
+    QFETCH(bool, alarms);
+    QSettings settings;
+    settings.remove(ALARM_RULES_KEY);
+    if (alarms) {
+        settings.beginWriteArray(ALARM_RULES_KEY);
+        for (int i = 0; i < ALARM_RULES; i++) {
+            settings.setArrayIndex(i);
+            settings.setValue(ALARM_PARAMETER_KEY, "P" + QString::number(i));
+            settings.setValue(ALARM_CONDITION_KEY, ALARM_CONDITION);
+        }
+        settings.endArray();
+        settings.sync();
+    }
+    MonitorWindow window;
+    window.show();
+
+    QVector<QString> stream = messages(parameters);
+    for (const QString &message : stream) apply(window, message);
+    apply(window, MESSAGE_FORMAT.arg(OTHER_PARAMETER).arg(0));
+    window.parameterSelected(selected ? "P0" : "P" + OTHER_PARAMETER);
+    render(window);
+
+    quint64 allocations = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < BENCHMARK_MESSAGES; i++) {
+        apply(window, stream.at(i % stream.size()));
+        if (i % FRAME_MESSAGES == FRAME_MESSAGES - 1) render(window);
+    }
+    record(BENCHMARK_MESSAGES, timer.nsecsElapsed(),
+           allocationCount() - allocations);
+}
+
+/*!
+ * \brief New parameters added to the parameter list and shown in one frame
+ */
+void WindowBenchmark::parameterList() {
+    MonitorWindow window;
+    window.show();
+    QVector<QString> stream = messages(LIST_PARAMETERS);
+    render(window);
+
+    quint64 allocations = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < LIST_PARAMETERS; i++) apply(window, stream.at(i));
+    render(window);
+    record(LIST_PARAMETERS, timer.nsecsElapsed(),
+           allocationCount() - allocations);
+}
+
+void WindowBenchmark::resizeStorm_data() {
+    QTest::addColumn<bool>("changingText");
+    QTest::newRow("fixed text") << false;
+    QTest::newRow("changing text") << true;
+}
+
+/*!
+ * \brief Window resizes alternating between two sizes
+ *
+ * With changing text a value of a different shape is shown before
+ * each resize
+ */
+void WindowBenchmark::resizeStorm() {
+    QFETCH(bool, changingText);
+    MonitorWindow window;
+    window.setWindowState(Qt::WindowNoState);
+    window.show();
+    QVector<QString> values;
+    for (int i = 0; i < VALUE_VARIANTS; i++) {
+        values << MESSAGE_FORMAT.arg(0).arg(QString(i % 12 + 1, '8'));
+    }
+    apply(window, values.first());
+    render(window);
+
+    quint64 allocations = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < RESIZE_COUNT; i++) {
+        if (changingText) {
+            apply(window, values.at(i % values.size()));
+            render(window);
+        }
+        window.resize(i % 2 ? RESIZE_LARGE : RESIZE_SMALL);
+        QCoreApplication::processEvents();
+    }
+    record(RESIZE_COUNT, timer.nsecsElapsed(),
+           allocationCount() - allocations);
+}
+
+/*!
+ * \brief Fitting the displayed text to an unchanged window
+ */
+void WindowBenchmark::resizeText() {
+    MonitorWindow window;
+    window.show();
+    apply(window, MESSAGE_FORMAT.arg(0).arg(12.345));
+    render(window);
+    QBENCHMARK {
+        window.resizeText();
+    }
+}
+
+/*!
+ * \brief Padding short values before display
+ */
+void WindowBenchmark::processText() {
+    MonitorWindow window;
+    QString text = "1.2 V";
+    QBENCHMARK {
+        window.processText(text);
+    }
+}
+
+/*!
+ * \brief Main function
+ *
+ * Selects the offscreen platform unless another one is requested
+ */
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    WindowBenchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "windowbenchmark.moc"
@@ -0,0 +1,348 @@
+/*!
+ * \file alarmengine.cpp
+ */
+#include "alarmengine.h"
+#include "valueparser.h"
+
+/*!
+ * \brief AlarmEngine constructor
+ */
+AlarmEngine::AlarmEngine() {}
+
+/*!
+ * \brief Loads rules from the \b ALARM_RULES_KEY array of a configuration
+ *
+ * Each entry has a \b ALARM_PARAMETER_KEY and a \b ALARM_CONDITION_KEY.
+ * Entries that cannot be parsed are skipped. Rules must be loaded
+ * before the parameter IDs are bound.
+ *
+ * \param settings: Application settings or an INI rule file
+ * \return Number of loaded rules
+ */
+int AlarmEngine::load(QSettings &settings) {
+    int loaded = 0;
+    int size = settings.beginReadArray(ALARM_RULES_KEY);
+    for (int i = 0; i < size; i++) {
+        settings.setArrayIndex(i);
+        if (addRule(settings.value(ALARM_PARAMETER_KEY).toString(),
+                    settings.value(ALARM_CONDITION_KEY).toString())) {
+            loaded++;
+        }
+    }
+    settings.endArray();
+    return loaded;
+}
+
+/*!
+ * \brief Adds a rule for a parameter
+ *
+ * \param parameter: Parameter name
+ * \param condition: Condition text, see \b ALARM_CONDITION_KEY
+ * \return True: Condition parsed and rule added
+ */
+bool AlarmEngine::addRule(const QString &parameter,
+                          const QString &condition) {
+    AlarmRule rule;
+    if (parameter == "" || !parseCondition(condition, rule)) return false;
+    rule.parameter = parameter;
+    rulesOf[parameter].append(rules.size());
+    rules.append(rule);
+    return true;
+}
+
+/*!
+ * \brief Returns the number of loaded rules
+ */
+int AlarmEngine::ruleCount() const {
+    return rules.size();
+}
+
+/*!
+ * \brief Returns the names of the parameters that have rules
+ */
+QStringList AlarmEngine::parameters() const {
+    return rulesOf.keys();
+}
+
+/*!
+ * \brief Compiles the rules of a parameter name for its ID
+ *
+ * \param id: Parameter ID
+ * \param name: Parameter name
+ * \param now: Current time in microseconds since epoch, missing
+ * rules count from this time until the first value arrives
+ */
+void AlarmEngine::bind(int id, const QString &name, qint64 now) {
+    if (id >= evaluators.size()) {
+        evaluators.resize(id + 1);
+        activeCount.resize(id + 1);
+        isChanged.resize(id + 1);
+    }
+    evaluators[id].clear();
+    activeCount[id] = 0;
+
+    for (int rule : rulesOf.value(name)) {
+        evaluators[id].append({rule, -1, now, 0, 0, false});
+    }
+}
+
+/*!
+ * \brief Removes the evaluators of a removed parameter
+ *
+ * \param id: Parameter ID
+ */
+void AlarmEngine::unbind(int id) {
+    if (id < 0 || id >= evaluators.size()) return;
+    evaluators[id].clear();
+    activeCount[id] = 0;
+}
+
+/*!
+ * \brief Removes the evaluators of all parameters, keeping the rules
+ */
+void AlarmEngine::clear() {
+    evaluators.clear();
+    activeCount.clear();
+    changed.clear();
+    isChanged.clear();
+}
+
+/*!
+ * \brief Evaluates the rules of a parameter for a new sample
+ *
+ * Values with a unit other than the one of a rule are not compared.
+ * Rates are computed from the sample timestamps, or from the receive
+ * times if the source sends none, so that samples received in one
+ * batch are not taken as a burst.
+ *
+ * \param id: Parameter ID with evaluators
+ * \param sample: Received sample
+ * \param now: Receive time in microseconds since epoch
+ * \return True: Alarm state of the parameter changed
+ */
+bool AlarmEngine::evaluateSample(int id, const Sample &sample, qint64 now) {
+    bool wasChanged = isChanged[id];
+    for (AlarmEvaluator &evaluator : evaluators[id]) {
+        const AlarmRule &rule = rules.at(evaluator.rule);
+        evaluator.lastSeen = now;
+
+        double number = sample.number;
+        bool hasNumber = sample.hasNumber;
+        if (hasNumber && rule.unit != "" && sample.format != SAMPLE_TEXT) {
+            hasNumber = sample.unit == rule.unit;
+        }
+        else if (hasNumber && rule.unit != "") {
+            QStringView unit;
+            hasNumber = ValueParser::parse(sample.value, number, unit)
+                        && unit == QStringView(rule.unit);
+        }
+
+        bool holds = false;
+        if (rule.kind == AlarmRule::Value) {
+            if (!hasNumber) continue;
+            holds = compare(rule.comparison, number, rule.limit);
+        }
+        else if (rule.kind == AlarmRule::Rate) {
+            qint64 time = sample.timestamp ? sample.timestamp : now;
+            if (!hasNumber || time <= evaluator.previousTime) continue;
+            if (evaluator.previousTime) {
+                double rate = qAbs(number - evaluator.previous) * 1000000
+                              / (time - evaluator.previousTime);
+                holds = compare(rule.comparison, rate, rule.limit);
+            }
+            evaluator.previous = number;
+            evaluator.previousTime = time;
+        }
+
+        if (!holds) evaluator.since = -1;
+        else if (evaluator.since < 0) evaluator.since = now;
+        setActive(id, evaluator, holds && now - evaluator.since
+                                          >= rule.duration);
+    }
+    return isChanged[id] && !wasChanged;
+}
+
+/*!
+ * \brief Evaluates the rules depending on time only
+ *
+ * Raises missing alarms and alarms whose condition held for their
+ * duration without a new value. Called periodically.
+ *
+ * \param now: Current time in microseconds since epoch
+ */
+void AlarmEngine::tick(qint64 now) {
+    for (int id = 0; id < evaluators.size(); id++) {
+        for (AlarmEvaluator &evaluator : evaluators[id]) {
+            const AlarmRule &rule = rules.at(evaluator.rule);
+            if (rule.kind == AlarmRule::Missing) {
+                setActive(id, evaluator,
+                          now - evaluator.lastSeen >= rule.duration);
+            }
+            else if (evaluator.since >= 0 && !evaluator.active
+                     && now - evaluator.since >= rule.duration) {
+                setActive(id, evaluator, true);
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Checks if a parameter has a raised alarm
+ *
+ * \param id: Parameter ID
+ */
+bool AlarmEngine::isActive(int id) const {
+    return id >= 0 && id < activeCount.size() && activeCount.at(id) > 0;
+}
+
+/*!
+ * \brief Returns the raised alarms of a parameter for display
+ *
+ * \param id: Parameter ID
+ * \return Rules as "parameter condition" separated by commas
+ */
+QString AlarmEngine::activeText(int id) const {
+    if (!isActive(id)) return "";
+    QStringList active;
+    for (const AlarmEvaluator &evaluator : evaluators.at(id)) {
+        if (!evaluator.active) continue;
+        const AlarmRule &rule = rules.at(evaluator.rule);
+        active << rule.parameter + " " + rule.text;
+    }
+    return active.join(", ");
+}
+
+/*!
+ * \brief Returns the IDs whose alarm state changed since clearChanged()
+ */
+const QVector<int> &AlarmEngine::changedIds() const {
+    return changed;
+}
+
+/*!
+ * \brief Forgets the changed IDs once they are displayed
+ */
+void AlarmEngine::clearChanged() {
+    for (int id : changed) {
+        if (id < isChanged.size()) isChanged[id] = false;
+    }
+    changed.clear();
+}
+
+/*!
+ * \brief Parses a condition
+ *
+ * Conditions are "[rate] <op> <limit>[ unit] [for <duration>]"
+ * with <op> one of <, <=, >, >=, ==, != and "missing [for] <duration>".
+ * Durations are numbers followed by ms, s or min, see parseDuration().
+ *
+ * \param condition: Condition text
+ * \param rule: Receives the parsed condition
+ * \return True: Condition is valid
+ */
+bool AlarmEngine::parseCondition(const QString &condition, AlarmRule &rule) {
+    QStringList tokens = condition.split(' ', Qt::SkipEmptyParts);
+    rule.text = tokens.join(' ');
+    rule.kind = AlarmRule::Value;
+    rule.comparison = AlarmRule::Greater;
+    rule.limit = 0;
+    rule.unit = "";
+    rule.duration = 0;
+    int i = 0;
+
+    if (tokens.value(i) == ALARM_MISSING) {
+        rule.kind = AlarmRule::Missing;
+        if (tokens.value(++i) == ALARM_FOR) i++;
+        return parseDuration(tokens.value(i), rule.duration)
+               && rule.duration > 0 && i + 1 == tokens.size();
+    }
+    if (tokens.value(i) == ALARM_RATE) {
+        rule.kind = AlarmRule::Rate;
+        i++;
+    }
+
+    static const char *operators[] = {"<=", ">=", "==", "!=", "<", ">"};
+    static const AlarmRule::Comparison comparisons[] = {
+        AlarmRule::LessOrEqual, AlarmRule::GreaterOrEqual, AlarmRule::Equal,
+        AlarmRule::NotEqual, AlarmRule::Less, AlarmRule::Greater
+    };
+    QString token = tokens.value(i++);
+    int op = 0;
+    while (op < 6 && !token.startsWith(operators[op])) op++;
+    if (op == 6) return false;
+    rule.comparison = comparisons[op];
+    token = token.mid(int(qstrlen(operators[op])));
+    if (token == "") token = tokens.value(i++);
+
+    QStringView unit;
+    if (!ValueParser::parse(token, rule.limit, unit)) return false;
+    rule.unit = unit.toString();
+    if (rule.unit == "" && i < tokens.size() && tokens.at(i) != ALARM_FOR) {
+        rule.unit = tokens.at(i++);
+    }
+
+    if (i < tokens.size()) {
+        if (tokens.at(i) != ALARM_FOR
+                || !parseDuration(tokens.value(i + 1), rule.duration)) {
+            return false;
+        }
+        i += 2;
+    }
+    return i == tokens.size();
+}
+
+/*!
+ * \brief Parses a duration such as "500ms", "2s" or "1min"
+ *
+ * Numbers without a unit are seconds
+ *
+ * \param text: Duration text
+ * \param duration: Receives the duration in microseconds
+ * \return True: Duration is valid
+ */
+bool AlarmEngine::parseDuration(const QString &text, qint64 &duration) {
+    double number;
+    QStringView unit;
+    if (!ValueParser::parse(text, number, unit) || number < 0) return false;
+
+    double scale;
+    if (unit == QStringView(u"ms")) scale = 1000;
+    else if (unit.isEmpty() || unit == QStringView(u"s")) scale = 1000000;
+    else if (unit == QStringView(u"min")) scale = 60000000;
+    else return false;
+    duration = qint64(number * scale);
+    return true;
+}
+
+/*!
+ * \brief Raises or clears the alarm of an evaluator
+ *
+ * \param id: Parameter ID
+ * \param evaluator: Evaluator of the parameter
+ * \param active: Determines, whether the alarm is raised
+ */
+void AlarmEngine::setActive(int id, AlarmEvaluator &evaluator, bool active) {
+    if (evaluator.active == active) return;
+    evaluator.active = active;
+    activeCount[id] += active ? 1 : -1;
+    if (!isChanged[id]) {
+        isChanged[id] = true;
+        changed.append(id);
+    }
+}
+
+/*!
+ * \brief Compares a value with a limit
+ */
+bool AlarmEngine::compare(AlarmRule::Comparison comparison, double value,
+                          double limit) {
+    switch (comparison) {
+    case AlarmRule::Less: return value < limit;
+    case AlarmRule::LessOrEqual: return value <= limit;
+    case AlarmRule::Greater: return value > limit;
+    case AlarmRule::GreaterOrEqual: return value >= limit;
+    case AlarmRule::Equal: return value == limit;
+    case AlarmRule::NotEqual: return value != limit;
+    }
+    return false;
+}
@@ -0,0 +1,119 @@
+/*!
+ * \file alarmengine.h
+ */
+#ifndef ALARMENGINE_H
+#define ALARMENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSettings>
+#include "sample.h"
+
+const QString ALARM_RULES_KEY = "AlarmRules"; /*!< QSettings array
+                                                   holding the rules */
+const QString ALARM_PARAMETER_KEY = "parameter"; /*!< Parameter name
+                                                      of a rule */
+const QString ALARM_CONDITION_KEY = "condition"; /*!< Condition of a rule,
+                e.g. "< 11.5 V for 2s", "rate > 0.5" or "missing 5s" */
+const QString ALARM_RATE = "rate"; /*!< Compares the change per second */
+const QString ALARM_MISSING = "missing"; /*!< Parameter not received */
+const QString ALARM_FOR = "for"; /*!< Precedes the duration of a rule */
+
+/*!
+ * \brief Alarm rule parsed from its condition text
+ */
+struct AlarmRule {
+    enum Kind {
+        Value, /*!< Compares the numeric value */
+        Rate, /*!< Compares the absolute change per second */
+        Missing /*!< No value received for the duration */
+    };
+    enum Comparison {
+        Less, LessOrEqual, Greater, GreaterOrEqual, Equal, NotEqual
+    };
+
+    QString parameter; /*!< Parameter name */
+    QString text; /*!< Condition as configured */
+    Kind kind; /*!< What is checked */
+    Comparison comparison; /*!< How the value or rate is compared */
+    double limit; /*!< Compared limit */
+    QString unit; /*!< Unit the value must have, empty for any */
+    qint64 duration; /*!< Time the condition must hold in microseconds */
+};
+
+/*!
+ * \brief State of one rule for one parameter ID
+ */
+struct AlarmEvaluator {
+    int rule; /*!< Index of the rule */
+    qint64 since; /*!< Time the condition started to hold, -1 if not */
+    qint64 lastSeen; /*!< Time of the last value */
+    double previous; /*!< Previous numeric value, for rates */
+    qint64 previousTime; /*!< Timestamp of the previous numeric value,
+                              or its receive time, 0 if none */
+    bool active; /*!< Determines, whether the alarm is raised */
+};
+
+/*!
+ * \brief AlarmEngine class
+ *
+ * Rules are parsed once when loaded and compiled into evaluators
+ * when a parameter ID is bound to a name. Evaluating a sample only
+ * walks the evaluators of its ID and does not allocate, so parameters
+ * without rules cost a single bounds check.
+ */
+class AlarmEngine {
+
+public:
+    AlarmEngine();
+
+    int load(QSettings &settings);
+    bool addRule(const QString &parameter, const QString &condition);
+    int ruleCount() const;
+    QStringList parameters() const;
+    void bind(int id, const QString &name, qint64 now);
+    void unbind(int id);
+    void clear();
+    inline bool evaluate(int id, const Sample &sample, qint64 now);
+    void tick(qint64 now);
+    bool isActive(int id) const;
+    QString activeText(int id) const;
+    const QVector<int> &changedIds() const;
+    void clearChanged();
+
+    static bool parseCondition(const QString &condition, AlarmRule &rule);
+    static bool parseDuration(const QString &text, qint64 &duration);
+
+private:
+    bool evaluateSample(int id, const Sample &sample, qint64 now);
+    void setActive(int id, AlarmEvaluator &evaluator, bool active);
+    static bool compare(AlarmRule::Comparison comparison, double value,
+                        double limit);
+
+    QVector<AlarmRule> rules; /*!< Loaded rules */
+    QHash<QString, QVector<int>> rulesOf; /*!< Rule indices of each name */
+    QVector<QVector<AlarmEvaluator>> evaluators; /*!< Evaluators of each
+                                                      parameter ID */
+    QVector<int> activeCount; /*!< Raised alarms of each parameter ID */
+    QVector<int> changed; /*!< IDs whose alarm state changed */
+    QVector<bool> isChanged; /*!< Determines, whether an ID is in changed */
+};
+
+/*!
+ * \brief Evaluates the rules of a parameter for a new sample
+ *
+ * \param id: Parameter ID
+ * \param sample: Received sample
+ * \param now: Receive time in microseconds since epoch
+ * \return True: Alarm state of the parameter changed
+ */
+inline bool AlarmEngine::evaluate(int id, const Sample &sample, qint64 now) {
+    if (id < 0 || id >= evaluators.size() || evaluators.at(id).isEmpty()) {
+        return false;
+    }
+    return evaluateSample(id, sample, now);
+}
+
+#endif // ALARMENGINE_H
@@ -0,0 +1,289 @@
+/*!
+ * \file binaryprotocol.cpp
+ */
+#include "binaryprotocol.h"
+#include "valueparser.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+/*!
+ * \brief Appends a little-endian integer to a byte array
+ *
+ * \param bytes: Target byte array
+ * \param value: Appended value
+ */
+template <typename T>
+void appendValue(QByteArray &bytes, T value) {
+    char data[sizeof(T)];
+    qToLittleEndian<T>(value, data);
+    bytes.append(data, sizeof(T));
+}
+
+/*!
+ * \brief Reads a little-endian integer
+ *
+ * \param data: Position of the value
+ * \return Read value
+ */
+template <typename T>
+T readValue(const char *data) {
+    return qFromLittleEndian<T>(data);
+}
+
+/*!
+ * \brief Reads the value of a record
+ *
+ * \param type: Value type
+ * \param p: Position of the value, moved past it
+ * \param end: End of the frame
+ * \param sample: Receives the value
+ * \return True: Value was read
+ */
+bool readRecordValue(quint8 type, const char *&p, const char *end,
+                     Sample &sample) {
+    if (type == BINARY_FLOAT64 || type == BINARY_INT64) {
+        if (end - p < 8) return false;
+        if (type == BINARY_FLOAT64) {
+            quint64 bits = readValue<quint64>(p);
+            std::memcpy(&sample.number, &bits, sizeof(bits));
+            sample.format = SAMPLE_FLOAT;
+        }
+        else {
+            sample.number = readValue<qint64>(p);
+            sample.format = SAMPLE_INTEGER;
+        }
+        sample.hasNumber = true;
+        p += 8;
+        return true;
+    }
+    if (type != BINARY_STRING || end - p < 2) return false;
+
+    int length = readValue<quint16>(p);
+    p += 2;
+    if (end - p < length) return false;
+    sample.value = QString::fromUtf8(p, length);
+    sample.hasNumber = ValueParser::parse(sample.value, sample.number);
+    p += length;
+    return true;
+}
+
+} // namespace
+
+/*!
+ * \brief BinaryEncoder constructor
+ */
+BinaryEncoder::BinaryEncoder() : records(0) {}
+
+/*!
+ * \brief Adds a floating point value
+ *
+ * \param name: Parameter name, may be empty if id has been named before
+ * \param value: Parameter value
+ * \param unit: Unit displayed after the value
+ * \param timestamp: Microseconds since epoch, 0 if not known
+ * \param id: Parameter ID, -1 if names are used instead
+ * \return True: Record added, false: name or unit too long
+ */
+bool BinaryEncoder::addDouble(const QString &name, double value,
+                              const QString &unit, qint64 timestamp, int id) {
+    if (!addHeader(BINARY_FLOAT64, name, unit, timestamp, id)) return false;
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendValue<quint64>(frame, bits);
+    return true;
+}
+
+/*!
+ * \brief Adds an integer value
+ *
+ * \param name: Parameter name, may be empty if id has been named before
+ * \param value: Parameter value
+ * \param unit: Unit displayed after the value
+ * \param timestamp: Microseconds since epoch, 0 if not known
+ * \param id: Parameter ID, -1 if names are used instead
+ * \return True: Record added, false: name or unit too long
+ */
+bool BinaryEncoder::addInteger(const QString &name, qint64 value,
+                               const QString &unit, qint64 timestamp, int id) {
+    if (!addHeader(BINARY_INT64, name, unit, timestamp, id)) return false;
+    appendValue<qint64>(frame, value);
+    return true;
+}
+
+/*!
+ * \brief Adds a text value
+ *
+ * \param name: Parameter name, may be empty if id has been named before
+ * \param value: Parameter value
+ * \param timestamp: Microseconds since epoch, 0 if not known
+ * \param id: Parameter ID, -1 if names are used instead
+ * \return True: Record added, false: name too long
+ */
+bool BinaryEncoder::addString(const QString &name, const QString &value,
+                              qint64 timestamp, int id) {
+    if (!addHeader(BINARY_STRING, name, QString(), timestamp, id)) {
+        return false;
+    }
+    QByteArray text = value.toUtf8().left(0xffff);
+    appendValue<quint16>(frame, quint16(text.size()));
+    frame.append(text);
+    return true;
+}
+
+/*!
+ * \brief Checks if a name or unit fits into a record
+ *
+ * \param text: Name or unit
+ * \return True: Text has at most \b BINARY_NAME_MAX UTF-8 bytes
+ */
+bool BinaryEncoder::fits(const QString &text) {
+    return text.size() <= BINARY_NAME_MAX / 3
+           || text.toUtf8().size() <= BINARY_NAME_MAX;
+}
+
+/*!
+ * \brief Returns the number of records added since the last finish()
+ */
+int BinaryEncoder::count() const {
+    return records;
+}
+
+/*!
+ * \brief Returns the built frame and starts a new one
+ */
+QByteArray BinaryEncoder::finish() {
+    QByteArray header(BINARY_MAGIC, 2);
+    header.append(char(BINARY_VERSION));
+    header.append(char(0));
+    appendValue<quint32>(header, records);
+
+    QByteArray result = header + frame;
+    frame.clear();
+    records = 0;
+    return result;
+}
+
+/*!
+ * \brief Appends the fixed fields, name and unit of a record
+ *
+ * \param type: Value type
+ * \param name: Parameter name
+ * \param unit: Unit displayed after the value
+ * \param timestamp: Microseconds since epoch
+ * \param id: Parameter ID, -1 if not used
+ * \return True: Header added, false: name or unit too long
+ */
+bool BinaryEncoder::addHeader(quint8 type, const QString &name,
+                              const QString &unit, qint64 timestamp, int id) {
+    QByteArray nameBytes = name.toUtf8();
+    QByteArray unitBytes = unit.toUtf8();
+    if (nameBytes.size() > BINARY_NAME_MAX
+            || unitBytes.size() > BINARY_NAME_MAX) return false;
+
+    appendValue<qint64>(frame, timestamp);
+    frame.append(char(id >= 0 ? type | BINARY_HAS_ID : type));
+    frame.append(char(nameBytes.size()));
+    frame.append(char(unitBytes.size()));
+    frame.append(char(0));
+    if (id >= 0) appendValue<quint16>(frame, quint16(id));
+    frame.append(nameBytes);
+    frame.append(unitBytes);
+    records++;
+    return true;
+}
+
+/*!
+ * \brief Decodes a binary frame
+ *
+ * Floating point and integer values keep their number and unit,
+ * the displayed text is only formatted for values that are shown
+ *
+ * \param frame: Received frame
+ * \param samples: Receives the decoded samples
+ * \return True: Frame was valid, false: frame was rejected as a whole
+ */
+bool BinaryDecoder::decode(const QByteArray &frame, QVector<Sample> &samples) {
+    const char *p = frame.constData();
+    const char *end = p + frame.size();
+    int start = samples.size();
+
+    if (frame.size() < BINARY_HEADER_SIZE || std::memcmp(p, BINARY_MAGIC, 2)
+            || quint8(p[2]) != BINARY_VERSION) return false;
+
+    quint32 records = readValue<quint32>(p + 4);
+    p += BINARY_HEADER_SIZE;
+
+    for (quint32 i = 0; i < records; i++) {
+        if (end - p < BINARY_RECORD_SIZE) break;
+        Sample sample;
+        sample.timestamp = readValue<qint64>(p);
+        quint8 type = quint8(p[8]);
+        int nameLength = quint8(p[9]);
+        int unitLength = quint8(p[10]);
+        p += BINARY_RECORD_SIZE;
+
+        int id = -1;
+        if (type & BINARY_HAS_ID) {
+            if (end - p < 2) break;
+            id = readValue<quint16>(p);
+            p += 2;
+        }
+        if (end - p < nameLength + unitLength) break;
+
+        if (nameLength) {
+            sample.name = cached(names, p, nameLength);
+            if (id >= 0) idNames.insert(quint16(id), sample.name);
+        }
+        else if (id >= 0) sample.name = idNames.value(quint16(id));
+        p += nameLength;
+        QString unit = cached(units, p, unitLength);
+        p += unitLength;
+
+        if (!readRecordValue(type & BINARY_TYPE_MASK, p, end, sample)) break;
+        if (sample.format != SAMPLE_TEXT) sample.unit = unit;
+        else if (!unit.isEmpty()) {
+            sample.value += QLatin1Char(' ');
+            sample.value += unit;
+        }
+        samples.append(sample);
+    }
+
+    if (p != end || samples.size() - start != int(records)) {
+        samples.resize(start);
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Forgets the names given to parameter IDs
+ *
+ * Called when a new connection is opened
+ */
+void BinaryDecoder::reset() {
+    idNames.clear();
+}
+
+/*!
+ * \brief Returns a shared string for repeated UTF-8 text
+ *
+ * \param cache: Cache to be used
+ * \param data: UTF-8 text
+ * \param length: Text length in bytes
+ * \return Decoded text
+ */
+QString BinaryDecoder::cached(QHash<QByteArray, QString> &cache,
+                              const char *data, int length) {
+    if (!length) return QString();
+    QHash<QByteArray, QString>::const_iterator it =
+            cache.constFind(QByteArray::fromRawData(data, length));
+    if (it != cache.constEnd()) return it.value();
+
+    QString text = QString::fromUtf8(data, length);
+    if (cache.size() < BINARY_CACHE_MAX) {
+        cache.insert(QByteArray(data, length), text);
+    }
+    return text;
+}
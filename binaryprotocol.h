@@ -0,0 +1,101 @@
+/*!
+ * \file binaryprotocol.h
+ *
+ * Compact binary message format sent as WebSocket binary frames.
+ * All integers are little-endian.
+ *
+ * Frame header, 8 bytes:
+ * - char[2] magic "MS"
+ * - quint8 version
+ * - quint8 reserved, 0
+ * - quint32 number of records
+ *
+ * Record:
+ * - qint64 timestamp in microseconds since epoch, 0 if not known
+ * - quint8 value type, ORed with \b BINARY_HAS_ID if an ID follows
+ * - quint8 name length in bytes
+ * - quint8 unit length in bytes
+ * - quint8 reserved, 0
+ * - quint16 parameter ID, only with \b BINARY_HAS_ID
+ * - UTF-8 name, may be empty if the ID has been named before
+ * - UTF-8 unit
+ * - value: float64, int64 or quint16 length followed by UTF-8 text
+ */
+#ifndef BINARYPROTOCOL_H
+#define BINARYPROTOCOL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "sample.h"
+
+const char BINARY_MAGIC[] = "MS"; /*!< First bytes of each binary frame */
+const quint8 BINARY_VERSION = 1; /*!< Current binary format version */
+const int BINARY_HEADER_SIZE = 8; /*!< Size of the frame header */
+const int BINARY_RECORD_SIZE = 12; /*!< Size of the fixed record fields */
+const quint8 BINARY_FLOAT64 = 1; /*!< Value type for floating point values */
+const quint8 BINARY_INT64 = 2; /*!< Value type for integer values */
+const quint8 BINARY_STRING = 3; /*!< Value type for text values */
+const quint8 BINARY_HAS_ID = 0x80; /*!< Set in the value type when
+                                        the record has a parameter ID */
+const quint8 BINARY_TYPE_MASK = 0x0f; /*!< Selects the value type */
+const int BINARY_NAME_MAX = 255; /*!< Longest name or unit in bytes */
+const int BINARY_CACHE_MAX = 65536; /*!< Maximum number of cached names
+                                         and units per decoder */
+
+/*!
+ * \brief BinaryEncoder class
+ *
+ * Builds a binary frame out of records. Records whose name or unit is
+ * longer than \b BINARY_NAME_MAX bytes are rejected rather than cut,
+ * so that a parameter is never renamed.
+ */
+class BinaryEncoder {
+
+public:
+    BinaryEncoder();
+
+    bool addDouble(const QString &name, double value,
+                   const QString &unit = QString(), qint64 timestamp = 0,
+                   int id = -1);
+    bool addInteger(const QString &name, qint64 value,
+                    const QString &unit = QString(), qint64 timestamp = 0,
+                    int id = -1);
+    bool addString(const QString &name, const QString &value,
+                   qint64 timestamp = 0, int id = -1);
+    int count() const;
+    QByteArray finish();
+
+    static bool fits(const QString &text);
+
+private:
+    bool addHeader(quint8 type, const QString &name, const QString &unit,
+                   qint64 timestamp, int id);
+
+    QByteArray frame; /*!< Frame being built */
+    quint32 records; /*!< Number of records in the frame */
+};
+
+/*!
+ * \brief BinaryDecoder class
+ *
+ * Decodes binary frames into samples. Names given to parameter IDs are
+ * remembered until reset(), so an ID has to be named once per connection.
+ */
+class BinaryDecoder {
+
+public:
+    bool decode(const QByteArray &frame, QVector<Sample> &samples);
+    void reset();
+
+private:
+    QString cached(QHash<QByteArray, QString> &cache, const char *data,
+                   int length);
+
+    QHash<quint16, QString> idNames; /*!< Parameter ID to name */
+    QHash<QByteArray, QString> names; /*!< Shares repeated names */
+    QHash<QByteArray, QString> units; /*!< Shares repeated units */
+};
+
+#endif // BINARYPROTOCOL_H
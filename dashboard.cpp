@@ -0,0 +1,278 @@
+/*!
+ * \file dashboard.cpp
+ */
+#include "dashboard.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <cmath>
+
+/*!
+ * \brief ValueTile constructor
+ *
+ * \param id: Shown parameter ID
+ * \param name: Shown parameter name
+ * \param fitter: Fit cache shared by the tiles
+ */
+ValueTile::ValueTile(int id, const QString &name, FontFitter *fitter,
+                     QWidget *parent) :
+    QWidget(parent), id(id), name(name), stale(false), alarm(false),
+    fitter(fitter) {
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setAutoFillBackground(false);
+}
+
+/*!
+ * \brief Returns the shown parameter ID
+ */
+int ValueTile::parameterId() const {
+    return id;
+}
+
+/*!
+ * \brief Changes the shown value, repainting the tile only if it differs
+ *
+ * \param newValue: New value
+ */
+void ValueTile::setValue(const QString &newValue) {
+    if (newValue == value) return;
+    value = newValue;
+    fitFont();
+    update();
+}
+
+/*!
+ * \brief Shows the value in \b STALE_COLOR while it is stale
+ *
+ * \param isStale: Determines, whether the value is stale
+ */
+void ValueTile::setStale(bool isStale) {
+    if (isStale == stale) return;
+    stale = isStale;
+    update();
+}
+
+/*!
+ * \brief Shows the value in \b ALARM_COLOR while an alarm is raised
+ *
+ * \param isAlarm: Determines, whether an alarm is raised
+ */
+void ValueTile::setAlarm(bool isAlarm) {
+    if (isAlarm == alarm) return;
+    alarm = isAlarm;
+    update();
+}
+
+/*!
+ * \brief Draws the parameter name and value
+ */
+void ValueTile::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Window));
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    int nameHeight = int(height() * TILE_NAME_RATIO);
+    painter.setPen(palette().color(QPalette::WindowText));
+    painter.setFont(nameFont);
+    painter.drawText(QRect(TILE_MARGIN, 0, width() - 2 * TILE_MARGIN,
+                           nameHeight), Qt::AlignLeft | Qt::AlignVCenter, name);
+    painter.setFont(valueFont);
+    if (alarm) painter.setPen(ALARM_COLOR);
+    else if (stale) painter.setPen(STALE_COLOR);
+    painter.drawText(QRect(0, nameHeight, width(), height() - nameHeight),
+                     Qt::AlignCenter, value);
+}
+
+/*!
+ * \brief Refits the fonts to the new tile size
+ */
+void ValueTile::resizeEvent(QResizeEvent *) {
+    fitFont();
+}
+
+/*!
+ * \brief Emits clicked() with the shown parameter ID
+ */
+void ValueTile::mousePressEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) emit clicked(id);
+}
+
+/*!
+ * \brief Fits the fonts of the value and the name to the tile size
+ */
+void ValueTile::fitFont() {
+    int nameHeight = int(height() * TILE_NAME_RATIO);
+    int textWidth = width() - 2 * TILE_MARGIN;
+    int pointSize = fitter->fit(font(), value,
+                                QSize(textWidth, height() - nameHeight));
+    valueFont = font();
+    valueFont.setPointSize(qMax(pointSize, 1));
+
+    pointSize = fitter->fit(font(), name, QSize(textWidth, nameHeight));
+    nameFont = font();
+    nameFont.setPointSize(qMax(pointSize, 1));
+}
+
+/*!
+ * \brief Dashboard constructor
+ */
+Dashboard::Dashboard(QWidget *parent) : QWidget(parent),
+    grid(new QGridLayout(this)), maximumTiles(GRID_TILES),
+    fitter(TILE_TEXT_LENGTH_MIN, TILE_SIZE_PERCENTAGE) {
+    grid->setSpacing(TILE_MARGIN);
+}
+
+/*!
+ * \brief Changes the maximum number of tiles
+ *
+ * Takes effect on the next rebuild()
+ *
+ * \param count: Maximum number of tiles
+ */
+void Dashboard::setMaximumTiles(int count) {
+    maximumTiles = qMax(count, 1);
+}
+
+/*!
+ * \brief Adds a tile for a new parameter if there is room for it
+ *
+ * \param id: Parameter ID
+ * \param name: Parameter name
+ */
+void Dashboard::addParameter(int id, const QString &name) {
+    if (tiles.size() >= maximumTiles) return;
+    if (id >= tileOf.size()) {
+        tileOf.insert(tileOf.size(), id + 1 - tileOf.size(), -1);
+    }
+    if (tileOf[id] >= 0) return;
+
+    ValueTile *tile = new ValueTile(id, name, &fitter, this);
+    QObject::connect(tile, SIGNAL(clicked(int)), this,
+                                                SIGNAL(tileClicked(int)));
+    tileOf[id] = tiles.size();
+    tiles.append(tile);
+    changed.append(tiles.size() - 1);
+    isChanged.append(true);
+    arrangeTiles();
+}
+
+/*!
+ * \brief Recreates the tiles from the parameters in the registry
+ *
+ * Called when parameters are removed
+ *
+ * \param registry: Received parameters
+ */
+void Dashboard::rebuild(const ParameterRegistry &registry) {
+    qDeleteAll(tiles);
+    tiles.clear();
+    changed.clear();
+    isChanged.clear();
+    tileOf.fill(-1, registry.capacity());
+
+    for (int id = 0; id < registry.capacity(); id++) {
+        if (registry.contains(id)) addParameter(id, registry.slot(id).name);
+    }
+    arrangeTiles();
+}
+
+/*!
+ * \brief Marks the tile of a parameter to be refreshed on the next frame
+ *
+ * \param id: Parameter ID
+ * \return True: Parameter has a tile
+ */
+bool Dashboard::markChanged(int id) {
+    if (id < 0 || id >= tileOf.size() || tileOf[id] < 0) return false;
+    int index = tileOf[id];
+    if (!isChanged[index]) {
+        isChanged[index] = true;
+        changed.append(index);
+    }
+    return true;
+}
+
+/*!
+ * \brief Updates the values of the changed tiles
+ *
+ * Tiles whose displayed text did not change are not repainted
+ *
+ * \param registry: Received parameters
+ */
+void Dashboard::refresh(const ParameterRegistry &registry) {
+    for (int index : changed) {
+        ValueTile *tile = tiles[index];
+        if (registry.contains(tile->parameterId())) {
+            tile->setValue(registry.slot(tile->parameterId()).text());
+            tile->setStale(false);
+        }
+        isChanged[index] = false;
+    }
+    changed.clear();
+}
+
+/*!
+ * \brief Flags the tiles whose value was received too long ago
+ * or restored from a snapshot
+ *
+ * Only tiles whose state changes are repainted
+ *
+ * \param registry: Received parameters
+ * \param now: Current time in microseconds since epoch
+ * \param threshold: Maximum age of a value in microseconds,
+ * 0 to flag restored values only
+ * \return Time the next tile becomes stale in microseconds since epoch,
+ * 0 if none
+ */
+qint64 Dashboard::updateStale(const ParameterRegistry &registry, qint64 now,
+                              qint64 threshold) {
+    qint64 next = 0;
+    for (ValueTile *tile : tiles) {
+        int id = tile->parameterId();
+        if (!registry.contains(id) || !registry.slot(id).received) {
+            tile->setStale(false);
+            continue;
+        }
+        const ParameterSlot &slot = registry.slot(id);
+        bool expires = threshold > 0 && !(slot.flags & PARAM_RESTORED);
+        bool stale = slot.flags & PARAM_RESTORED
+                     || (threshold > 0 && now - slot.received > threshold);
+        tile->setStale(stale);
+        if (expires && !stale && (!next || slot.received + threshold < next)) {
+            next = slot.received + threshold;
+        }
+    }
+    return next;
+}
+
+/*!
+ * \brief Flags the tile of a parameter with a raised alarm
+ *
+ * \param id: Parameter ID
+ * \param isAlarm: Determines, whether an alarm is raised
+ */
+void Dashboard::setAlarm(int id, bool isAlarm) {
+    if (id < 0 || id >= tileOf.size() || tileOf[id] < 0) return;
+    tiles[tileOf[id]]->setAlarm(isAlarm);
+}
+
+/*!
+ * \brief Returns the IDs of the parameters that have a tile
+ */
+QVector<int> Dashboard::parameterIds() const {
+    QVector<int> ids;
+    ids.reserve(tiles.size());
+    for (ValueTile *tile : tiles) ids.append(tile->parameterId());
+    return ids;
+}
+
+/*!
+ * \brief Places the tiles in a grid as close to square as possible
+ */
+void Dashboard::arrangeTiles() {
+    int columns = qMax(int(std::ceil(std::sqrt(double(tiles.size())))), 1);
+    for (ValueTile *tile : tiles) grid->removeWidget(tile);
+    for (int i = 0; i < tiles.size(); i++) {
+        grid->addWidget(tiles[i], i / columns, i % columns);
+    }
+}
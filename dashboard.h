@@ -0,0 +1,103 @@
+/*!
+ * \file dashboard.h
+ */
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <QWidget>
+#include <QGridLayout>
+#include <QVector>
+#include <QColor>
+#include "parameterregistry.h"
+#include "fontfitter.h"
+
+const int GRID_TILES = 20; /*!< Default maximum number of tiles */
+const int TILE_MARGIN = 4; /*!< Space around tile contents in pixels */
+const float TILE_NAME_RATIO = 0.2f; /*!< Share of the tile height
+                                         used by the parameter name */
+const float TILE_SIZE_PERCENTAGE = 0.9f; /*!< Fitted size is multiplied
+                                              by this value */
+const int TILE_TEXT_LENGTH_MIN = 7; /*!< Text shorter than this is padded
+                                         before fitting */
+const QColor STALE_COLOR(Qt::gray); /*!< Color of values not updated
+                                         within the stale threshold */
+const QColor ALARM_COLOR(Qt::red); /*!< Color of values with a raised alarm */
+
+/*!
+ * \brief ValueTile class
+ *
+ * Shows the name and value of one parameter with a font fitted
+ * to the tile. Fits are shared between tiles through the cache
+ * of the dashboard.
+ */
+class ValueTile : public QWidget {
+    Q_OBJECT
+
+public:
+    ValueTile(int id, const QString &name, FontFitter *fitter,
+              QWidget *parent = 0);
+
+    int parameterId() const;
+    void setValue(const QString &value);
+    void setStale(bool isStale);
+    void setAlarm(bool isAlarm);
+
+signals:
+    void clicked(int id);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+
+private:
+    void fitFont();
+
+    int id; /*!< Shown parameter ID */
+    QString name; /*!< Shown parameter name */
+    QString value; /*!< Shown value */
+    bool stale; /*!< Determines, whether the value is shown as stale */
+    bool alarm; /*!< Determines, whether the value is shown as alarmed */
+    QFont valueFont; /*!< Fitted font for the value */
+    QFont nameFont; /*!< Font for the parameter name */
+    FontFitter *fitter; /*!< Fit cache shared by the tiles */
+};
+
+/*!
+ * \brief Dashboard class
+ *
+ * Shows several parameters at once in a grid of tiles. Only tiles
+ * whose parameter changed since the previous frame are repainted.
+ */
+class Dashboard : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit Dashboard(QWidget *parent = 0);
+
+    void setMaximumTiles(int count);
+    void addParameter(int id, const QString &name);
+    void rebuild(const ParameterRegistry &registry);
+    bool markChanged(int id);
+    void refresh(const ParameterRegistry &registry);
+    qint64 updateStale(const ParameterRegistry &registry, qint64 now,
+                       qint64 threshold);
+    void setAlarm(int id, bool isAlarm);
+    QVector<int> parameterIds() const;
+
+signals:
+    void tileClicked(int id);
+
+private:
+    void arrangeTiles();
+
+    QGridLayout *grid; /*!< Layout of the tiles */
+    QVector<ValueTile*> tiles; /*!< Tiles in order of appearance */
+    QVector<int> tileOf; /*!< Tile index of each parameter ID, -1 if none */
+    QVector<int> changed; /*!< Indices of tiles to be refreshed */
+    QVector<bool> isChanged; /*!< Determines, whether a tile is in changed */
+    int maximumTiles; /*!< Maximum number of tiles */
+    FontFitter fitter; /*!< Fit cache shared by the tiles */
+};
+
+#endif // DASHBOARD_H
@@ -0,0 +1,172 @@
+/*!
+ * \file fontfitter.cpp
+ */
+#include "fontfitter.h"
+#include <QFontMetricsF>
+
+/*!
+ * \brief FontFitter constructor
+ *
+ * \param minLength: Shorter text is padded with spaces when measured
+ * \param fill: Share of the available size the text may use
+ */
+FontFitter::FontFitter(int minLength, double fill) : minLength(minLength),
+    fill(fill) {}
+
+/*!
+ * \brief Returns the largest point size at which the text fits
+ *
+ * \param font: Font to be fitted, its point size is ignored
+ * \param text: Displayed text
+ * \param available: Available size in pixels
+ * \return Point size, 0 if the text cannot be fitted
+ */
+int FontFitter::fit(const QFont &font, const QString &text,
+                    const QSize &available) {
+    quint64 key = hash(font, text, available);
+    QHash<quint64, FitEntry>::const_iterator it = cache.constFind(key);
+
+    if (it != cache.constEnd() && matches(it.value(), font, text, available)) {
+        return it.value().pointSize;
+    }
+
+    if (cache.size() >= FIT_CACHE_MAX) cache.clear();
+    FitEntry entry;
+    entry.family = font.family();
+    entry.weight = font.weight();
+    entry.style = font.style();
+    entry.signature = signature(text);
+    entry.size = available;
+    entry.pointSize = measure(font, text, available);
+    cache.insert(key, entry);
+    return entry.pointSize;
+}
+
+/*!
+ * \brief Clears the cache
+ */
+void FontFitter::clear() {
+    cache.clear();
+}
+
+/*!
+ * \brief Adds spaces around text shorter than the minimum length
+ *
+ * \param text: Displayed text
+ * \param minLength: Minimum text length
+ * \return Padded text
+ */
+QString FontFitter::pad(const QString &text, int minLength) {
+    if (text.length() >= minLength) return text;
+    int spaces = (minLength - text.length() + 1) / 2;
+    QString padded(text.length() + 2 * spaces, ' ');
+    padded.replace(spaces, text.length(), text);
+    return padded;
+}
+
+/*!
+ * \brief Returns the character class signature of a text
+ *
+ * \param text: Displayed text
+ * \return Text with every digit replaced by '0'
+ */
+QString FontFitter::signature(const QString &text) {
+    QString result(text.length(), Qt::Uninitialized);
+    for (int i = 0; i < text.length(); i++) {
+        result[i] = QChar(charClass(text.at(i)));
+    }
+    return result;
+}
+
+/*!
+ * \brief Measures the text once at \b FIT_REFERENCE_SIZE and scales
+ * the point size by the ratio of available to measured size
+ *
+ * Rounding in the font engine may make the estimate slightly too large,
+ * so it is checked and reduced at most \b FIT_STEPS_MAX times
+ *
+ * \param font: Font to be fitted
+ * \param text: Displayed text
+ * \param available: Available size in pixels
+ * \return Point size, 0 if the text cannot be fitted
+ */
+int FontFitter::measure(const QFont &font, const QString &text,
+                        const QSize &available) const {
+    if (available.width() <= 0 || available.height() <= 0) return 0;
+    QString padded = pad(text, minLength);
+    QFont reference(font);
+    reference.setPointSize(FIT_REFERENCE_SIZE);
+    QFontMetricsF metrics(reference);
+
+    double width = metrics.horizontalAdvance(padded);
+    double height = metrics.height();
+    if (width <= 0 || height <= 0) return 0;
+
+    double maxWidth = available.width() * fill;
+    double maxHeight = available.height() * fill;
+    int pointSize = int(FIT_REFERENCE_SIZE * qMin(maxWidth / width,
+                                                  maxHeight / height));
+
+    for (int i = 0; i < FIT_STEPS_MAX && pointSize > 1; i++) {
+        reference.setPointSize(pointSize);
+        QFontMetricsF check(reference);
+        double ratio = qMin(maxWidth / check.horizontalAdvance(padded),
+                            maxHeight / check.height());
+        if (ratio >= 1) break;
+        pointSize = qMin(pointSize - 1, int(pointSize * ratio));
+    }
+    return qMax(pointSize, 1);
+}
+
+/*!
+ * \brief Hashes the font, the character class signature of a text and
+ * the available size without building the signature
+ *
+ * \param font: Font to be fitted
+ * \param text: Displayed text
+ * \param available: Available size in pixels
+ * \return Hash value
+ */
+quint64 FontFitter::hash(const QFont &font, const QString &text,
+                         const QSize &available) {
+    quint64 value = 14695981039346656037ULL;
+    const quint64 prime = 1099511628211ULL;
+    value = (value ^ qHash(font.family())) * prime;
+    value = (value ^ quint64(font.weight())) * prime;
+    value = (value ^ quint64(font.style())) * prime;
+    for (QChar c : text) value = (value ^ charClass(c)) * prime;
+    value = (value ^ quint64(available.width())) * prime;
+    value = (value ^ quint64(available.height())) * prime;
+    return value;
+}
+
+/*!
+ * \brief Checks if a cached fit applies to a font, text and size
+ *
+ * \param entry: Cached fit
+ * \param font: Font to be fitted
+ * \param text: Displayed text
+ * \param available: Available size in pixels
+ * \return True: Font, character class signature and size match
+ */
+bool FontFitter::matches(const FitEntry &entry, const QFont &font,
+                         const QString &text, const QSize &available) {
+    const QString &signature = entry.signature;
+    if (entry.size != available || text.length() != signature.length()
+            || entry.weight != font.weight() || entry.style != font.style()
+            || entry.family != font.family()) return false;
+    for (int i = 0; i < text.length(); i++) {
+        if (charClass(text.at(i)) != signature.at(i).unicode()) return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Returns the character class of a character
+ *
+ * \param c: Character
+ * \return '0' for digits, the character itself otherwise
+ */
+ushort FontFitter::charClass(QChar c) {
+    return c.unicode() >= '0' && c.unicode() <= '9' ? '0' : c.unicode();
+}
@@ -0,0 +1,64 @@
+/*!
+ * \file fontfitter.h
+ */
+#ifndef FONTFITTER_H
+#define FONTFITTER_H
+
+#include <QFont>
+#include <QHash>
+#include <QSize>
+#include <QString>
+
+const int FIT_REFERENCE_SIZE = 100; /*!< Point size used when measuring */
+const int FIT_STEPS_MAX = 3; /*!< Maximum number of corrections
+                                  after the initial estimate */
+const int FIT_CACHE_MAX = 256; /*!< Cache is cleared when it grows
+                                    beyond this many entries */
+
+/*!
+ * \brief Cached result of a fit
+ */
+struct FitEntry {
+    QString family; /*!< Font family */
+    int weight; /*!< Font weight */
+    QFont::Style style; /*!< Font style */
+    QString signature; /*!< Character class signature of the text */
+    QSize size; /*!< Available size */
+    int pointSize; /*!< Fitted point size */
+};
+
+/*!
+ * \brief FontFitter class
+ *
+ * Finds the largest point size at which a text fits a given size.
+ * Results are cached by the font family and style, the character class
+ * signature of the text, in which every digit is replaced by '0', and
+ * the available size, so values of the same shape such as "14.257 V"
+ * and "14.312 V" are measured only once.
+ */
+class FontFitter {
+
+public:
+    FontFitter(int minLength, double fill);
+
+    int fit(const QFont &font, const QString &text, const QSize &available);
+    void clear();
+    static QString pad(const QString &text, int minLength);
+    static QString signature(const QString &text);
+
+private:
+    int measure(const QFont &font, const QString &text,
+                const QSize &available) const;
+    static quint64 hash(const QFont &font, const QString &text,
+                        const QSize &available);
+    static bool matches(const FitEntry &entry, const QFont &font,
+                        const QString &text, const QSize &available);
+    static ushort charClass(QChar c);
+
+    QHash<quint64, FitEntry> cache; /*!< Fits by font, signature and size
+                                         hash */
+    int minLength; /*!< Shorter text is padded with spaces when measured */
+    double fill; /*!< Share of the available size the text may use */
+};
+
+#endif // FONTFITTER_H
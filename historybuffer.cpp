@@ -0,0 +1,202 @@
+/*!
+ * \file historybuffer.cpp
+ */
+#include "historybuffer.h"
+
+/*!
+ * \brief HistoryBuffer constructor
+ */
+HistoryBuffer::HistoryBuffer() : first(0), size(0) {}
+
+/*!
+ * \brief Appends a point, overwriting the oldest one if the buffer is full
+ *
+ * \param time: Receive time in milliseconds
+ * \param value: Numeric value
+ */
+void HistoryBuffer::append(qint64 time, double value) {
+    if (points.isEmpty()) return;
+    HistoryPoint point = {time, value};
+
+    if (size < points.size()) {
+        points[(first + size) % points.size()] = point;
+        size++;
+    }
+    else {
+        points[first] = point;
+        first = (first + 1) % points.size();
+    }
+}
+
+/*!
+ * \brief Changes the capacity, keeping the newest points
+ *
+ * \param newCapacity: Number of points the buffer can hold
+ */
+void HistoryBuffer::setCapacity(int newCapacity) {
+    int kept = qMin(size, newCapacity);
+    QVector<HistoryPoint> newPoints(newCapacity);
+    for (int i = 0; i < kept; i++) newPoints[i] = at(size - kept + i);
+
+    points.swap(newPoints);
+    first = 0;
+    size = kept;
+}
+
+/*!
+ * \brief Returns the number of points the buffer can hold
+ */
+int HistoryBuffer::capacity() const {
+    return points.size();
+}
+
+/*!
+ * \brief Returns the number of stored points
+ */
+int HistoryBuffer::count() const {
+    return size;
+}
+
+/*!
+ * \brief Checks if the next point overwrites the oldest one
+ */
+bool HistoryBuffer::isFull() const {
+    return size == points.size();
+}
+
+/*!
+ * \brief Returns a stored point
+ *
+ * \param i: Index of the point, 0 being the oldest
+ */
+const HistoryPoint &HistoryBuffer::at(int i) const {
+    return points[(first + i) % points.size()];
+}
+
+/*!
+ * \brief Finds the oldest point received at or after a given time
+ *
+ * \param time: Receive time in milliseconds
+ * \return Index of the point, count() if there is none
+ */
+int HistoryBuffer::lowerBound(qint64 time) const {
+    int low = 0, high = size;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (at(middle).time < time) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+/*!
+ * \brief HistoryStore constructor
+ *
+ * \param budgetBytes: Memory available for points in bytes
+ */
+HistoryStore::HistoryStore(qint64 budgetBytes) : budget(budgetBytes),
+    used(0) {}
+
+/*!
+ * \brief Changes the memory budget
+ *
+ * Existing buffers are shrunk if they exceed the new budget
+ *
+ * \param budgetBytes: Memory available for points in bytes
+ */
+void HistoryStore::setBudget(qint64 budgetBytes) {
+    budget = budgetBytes;
+    if (used > budget) reclaim(used - budget);
+}
+
+/*!
+ * \brief Appends a point to the history of a parameter
+ *
+ * \param id: Parameter ID
+ * \param time: Receive time in milliseconds
+ * \param value: Numeric value
+ */
+void HistoryStore::append(int id, qint64 time, double value) {
+    if (id >= buffers.size()) buffers.resize(id + 1);
+    HistoryBuffer &history = buffers[id];
+    const qint64 pointSize = sizeof(HistoryPoint);
+
+    if (!history.capacity()) {
+        qint64 bytes = HISTORY_INITIAL_CAPACITY * pointSize;
+        if (used + bytes > budget) reclaim(used + bytes - budget);
+        if (used + bytes > budget) return;
+        history.setCapacity(HISTORY_INITIAL_CAPACITY);
+        used += bytes;
+    }
+    else if (history.isFull()) {
+        qint64 bytes = history.capacity() * pointSize;
+        if (used + bytes <= budget) {
+            history.setCapacity(history.capacity() * 2);
+            used += bytes;
+        }
+    }
+    history.append(time, value);
+}
+
+/*!
+ * \brief Removes the history of a parameter
+ *
+ * \param id: Parameter ID
+ */
+void HistoryStore::remove(int id) {
+    if (id < 0 || id >= buffers.size()) return;
+    used -= buffers[id].capacity() * qint64(sizeof(HistoryPoint));
+    buffers[id] = HistoryBuffer();
+}
+
+/*!
+ * \brief Removes all histories
+ */
+void HistoryStore::clear() {
+    buffers.clear();
+    used = 0;
+}
+
+/*!
+ * \brief Returns the history of a parameter
+ *
+ * \param id: Parameter ID
+ * \return History buffer, null if the parameter has no history
+ */
+const HistoryBuffer *HistoryStore::buffer(int id) const {
+    if (id < 0 || id >= buffers.size() || !buffers[id].capacity()) return 0;
+    return &buffers[id];
+}
+
+/*!
+ * \brief Returns the memory allocated for points in bytes
+ */
+qint64 HistoryStore::usedBytes() const {
+    return used;
+}
+
+/*!
+ * \brief Frees memory by halving the largest buffers
+ *
+ * Buffers are not shrunk below \b HISTORY_INITIAL_CAPACITY
+ *
+ * \param bytes: Memory to be freed in bytes
+ */
+void HistoryStore::reclaim(qint64 bytes) {
+    const qint64 pointSize = sizeof(HistoryPoint);
+
+    while (bytes > 0) {
+        int largest = -1;
+        for (int i = 0; i < buffers.size(); i++) {
+            if (largest < 0 || buffers[i].capacity()
+                                    > buffers[largest].capacity()) largest = i;
+        }
+        if (largest < 0
+            || buffers[largest].capacity() <= HISTORY_INITIAL_CAPACITY) return;
+
+        int freed = buffers[largest].capacity() / 2;
+        buffers[largest].setCapacity(buffers[largest].capacity() - freed);
+        used -= freed * pointSize;
+        bytes -= freed * pointSize;
+    }
+}
@@ -0,0 +1,75 @@
+/*!
+ * \file historybuffer.h
+ */
+#ifndef HISTORYBUFFER_H
+#define HISTORYBUFFER_H
+
+#include <QVector>
+#include <QtGlobal>
+
+const int HISTORY_INITIAL_CAPACITY = 1024; /*!< Number of points allocated
+                                                for a new parameter */
+const int HISTORY_MEMORY = 64; /*!< Default history memory budget in MiB */
+const qint64 HISTORY_MIB = 1024 * 1024; /*!< Bytes in a MiB */
+
+/*!
+ * \brief Numeric sample stored in the history
+ */
+struct HistoryPoint {
+    qint64 time; /*!< Receive time in milliseconds */
+    double value; /*!< Numeric value */
+};
+
+/*!
+ * \brief Fixed capacity ring buffer of numeric samples
+ *
+ * The oldest point is overwritten when the buffer is full
+ */
+class HistoryBuffer {
+
+public:
+    HistoryBuffer();
+
+    void append(qint64 time, double value);
+    void setCapacity(int newCapacity);
+    int capacity() const;
+    int count() const;
+    bool isFull() const;
+    const HistoryPoint &at(int i) const;
+    int lowerBound(qint64 time) const;
+
+private:
+    QVector<HistoryPoint> points; /*!< Point storage */
+    int first; /*!< Index of the oldest point */
+    int size; /*!< Number of stored points */
+};
+
+/*!
+ * \brief HistoryStore class
+ *
+ * Keeps a history buffer for each parameter ID within a total memory
+ * budget. Buffers grow while memory is available, after which they
+ * overwrite their oldest points. A new parameter takes memory from the
+ * largest buffer when the budget is exhausted.
+ */
+class HistoryStore {
+
+public:
+    explicit HistoryStore(qint64 budgetBytes = HISTORY_MEMORY * HISTORY_MIB);
+
+    void setBudget(qint64 budgetBytes);
+    void append(int id, qint64 time, double value);
+    void remove(int id);
+    void clear();
+    const HistoryBuffer *buffer(int id) const;
+    qint64 usedBytes() const;
+
+private:
+    void reclaim(qint64 bytes);
+
+    QVector<HistoryBuffer> buffers; /*!< Buffers indexed by parameter ID */
+    qint64 budget; /*!< Memory budget in bytes */
+    qint64 used; /*!< Memory allocated for points in bytes */
+};
+
+#endif // HISTORYBUFFER_H
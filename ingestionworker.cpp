@@ -0,0 +1,365 @@
+/*!
+ * \file ingestionworker.cpp
+ */
+#include "ingestionworker.h"
+#include "monitorwindow.h"
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+
+/*!
+ * \brief IngestionWorker constructor
+ *
+ * The socket is created in start() so that it lives in the worker thread
+ *
+ * \param queue: Queue shared with the GUI thread
+ * \param prefix: Prepended to received parameter names, empty to keep
+ * the names as sent
+ */
+IngestionWorker::IngestionWorker(SampleQueue<Sample> *queue,
+                                 const QString &prefix, QObject *parent)
+    : QObject(parent), queue(queue), socket(0), prefix(prefix),
+      autoConnect(false), reconnectTimer(0), attempts(0), recorder(0),
+      recordTimer(0), replayer(0), replaySpeed(1), dropped(0) {}
+
+/*!
+ * \brief Returns the number of samples dropped due to a full queue
+ */
+quint64 IngestionWorker::droppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Sets the recorder of received messages, called before start()
+ *
+ * \param newRecorder: Recorder living in another thread, 0 to not record
+ */
+void IngestionWorker::setRecorder(Recorder *newRecorder) {
+    recorder = newRecorder;
+}
+
+/*!
+ * \brief Creates the socket, called once the worker has been
+ * moved to its thread
+ */
+void IngestionWorker::start() {
+    socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+
+    QObject::connect(socket, SIGNAL(connected()), this,
+                                                SLOT(socketConnected()));
+    QObject::connect(socket, SIGNAL(disconnected()), this,
+                                                SLOT(socketDisconnected()));
+    QObject::connect(socket, SIGNAL(textMessageReceived(QString)), this,
+                                                SLOT(messageReceived(QString)));
+    QObject::connect(socket, SIGNAL(binaryMessageReceived(QByteArray)), this,
+                            SLOT(binaryMessageReceived(QByteArray)));
+
+    QObject::connect(socket, SIGNAL(error(QAbstractSocket::SocketError)),
+                     this, SLOT(socketError(QAbstractSocket::SocketError)));
+
+    reconnectTimer = new QTimer(this);
+    reconnectTimer->setSingleShot(true);
+    QObject::connect(reconnectTimer, SIGNAL(timeout()), this,
+                                                SLOT(reconnect()));
+
+    if (recorder) {
+        recordTimer = new QTimer(this);
+        QObject::connect(recordTimer, SIGNAL(timeout()), this,
+                                                SLOT(flushRecording()));
+        recordTimer->start(RECORD_FLUSH_INTERVAL);
+    }
+}
+
+/*!
+ * \brief Closes the current connection and connects to a new URI
+ *
+ * \param newUri: WebSocket URI
+ */
+void IngestionWorker::open(QUrl newUri) {
+    closeConnection();
+    uri = newUri;
+    autoConnect = true;
+    attempts = 0;
+    if (socket->state() == QAbstractSocket::UnconnectedState) reconnect();
+}
+
+/*!
+ * \brief Closes the current WebSocket connection
+ */
+void IngestionWorker::closeConnection() {
+    if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        socket->sendTextMessage(APP_NAME + DISCONNECTED_MESSAGE);
+        socket->close();
+    }
+    autoConnect = false;
+    if (reconnectTimer) reconnectTimer->stop();
+    if (replayer) replayer->stop();
+    flushRecording();
+}
+
+/*!
+ * \brief Returns the counters of received and decoded messages
+ */
+IngestionStats &IngestionWorker::stats() {
+    return ingestionStats;
+}
+
+/*!
+ * \brief Called when the socket is connected
+ */
+void IngestionWorker::socketConnected() {
+    attempts = 0;
+    binaryDecoder.reset();
+    socket->sendTextMessage(APP_NAME + CONNECTED_TO_TEXT + uri.toString());
+    if (!subscription.isEmpty()) {
+        socket->sendTextMessage(Subscription::encode(JSON_SUBSCRIBE,
+                                                     subscription));
+    }
+    emit connected();
+}
+
+/*!
+ * \brief Asks the server to send only the given parameters
+ *
+ * The subscription is sent again on each new connection
+ *
+ * \param names: Parameter names, empty to receive all parameters
+ */
+void IngestionWorker::subscribe(QStringList names) {
+    subscription = names;
+    if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        socket->sendTextMessage(Subscription::encode(JSON_SUBSCRIBE, names));
+    }
+}
+
+/*!
+ * \brief Sends a text message if connected
+ *
+ * \param message: Message to be sent
+ */
+void IngestionWorker::send(QString message) {
+    if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        socket->sendTextMessage(message);
+    }
+}
+
+/*!
+ * \brief Called when the socket is disconnected
+ */
+void IngestionWorker::socketDisconnected() {
+    emit disconnected();
+    scheduleReconnect();
+}
+
+/*!
+ * \brief Called when the connection fails
+ *
+ * \param error: Socket error
+ */
+void IngestionWorker::socketError(QAbstractSocket::SocketError error) {
+    Q_UNUSED(error);
+    scheduleReconnect();
+}
+
+/*!
+ * \brief Decodes a received message and hands it to the GUI thread
+ *
+ * Catalog messages are passed on as names instead of samples
+ *
+ * \param message: Received message, a single sample, a batch or a catalog
+ */
+void IngestionWorker::messageReceived(QString message) {
+    if (recorder) {
+        QByteArray bytes = message.toUtf8();
+        record(false, bytes.constData(), bytes.size());
+    }
+    if (Subscription::decode(message, JSON_CATALOG, catalog)) {
+        for (QString &name : catalog) qualify(name);
+        emit catalogReceived(catalog);
+        return;
+    }
+    quint64 size = IngestionStats::utf8Size(message);
+    QElapsedTimer timer;
+    timer.start();
+    samples.clear();
+    decoder.decode(message, samples);
+    stamp(samples);
+    ingestionStats.addMessage(size, quint64(samples.size()),
+                              quint64(timer.nsecsElapsed()));
+    publish(samples);
+}
+
+/*!
+ * \brief Decodes a received binary message and hands it to the GUI thread
+ *
+ * Invalid frames are ignored
+ *
+ * \param message: Received message in the format of binaryprotocol.h
+ */
+void IngestionWorker::binaryMessageReceived(QByteArray message) {
+    if (recorder) record(true, message.constData(), message.size());
+    QElapsedTimer timer;
+    timer.start();
+    samples.clear();
+    binaryDecoder.decode(message, samples);
+    stamp(samples);
+    ingestionStats.addMessage(quint64(message.size()), quint64(samples.size()),
+                              quint64(timer.nsecsElapsed()));
+    publish(samples);
+}
+
+/*!
+ * \brief Replays a recording instead of connecting
+ *
+ * Replayed messages are decoded, published and counted like received
+ * ones. \b replayFinished is emitted with the number of messages once
+ * the recording ends. At maximum speed the replay is paused while the
+ * queue is filled beyond \b REPLAY_QUEUE_HIGH, until resumeReplay().
+ *
+ * \param path: First segment of the recording
+ * \param speed: Speed factor, 0 for maximum speed
+ */
+void IngestionWorker::replay(QString path, double speed) {
+    closeConnection();
+    if (!replayer) {
+        replayer = new Replayer(this);
+        QObject::connect(replayer, SIGNAL(textFrame(QString)), this,
+                         SLOT(messageReceived(QString)), Qt::DirectConnection);
+        QObject::connect(replayer, SIGNAL(binaryFrame(QByteArray)), this,
+                         SLOT(binaryMessageReceived(QByteArray)),
+                         Qt::DirectConnection);
+        QObject::connect(replayer, SIGNAL(finished(quint64,qint64)), this,
+                         SIGNAL(replayFinished(quint64)));
+    }
+    if (!replayer->open(path)) {
+        emit replayFinished(0);
+        return;
+    }
+    replaySpeed = speed;
+    binaryDecoder.reset();
+    emit connected();
+    replayer->start(speed);
+}
+
+/*!
+ * \brief Continues a replay paused by a full queue, called once the
+ * GUI thread has drained the queue
+ */
+void IngestionWorker::resumeReplay() {
+    if (replayer) replayer->resume();
+}
+
+/*!
+ * \brief Hands the buffered frames to the recorder
+ */
+void IngestionWorker::flushRecording() {
+    if (!recorder || recordBuffer.isEmpty()) return;
+    QMetaObject::invokeMethod(recorder, "write", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, recordBuffer));
+    recordBuffer.clear();
+}
+
+/*!
+ * \brief Buffers a received message as a frame of the recording
+ *
+ * \param isBinary: Determines, whether the message is a binary message
+ * \param data: Message bytes
+ * \param size: Number of message bytes
+ */
+void IngestionWorker::record(bool isBinary, const char *data, int size) {
+    Recorder::appendFrame(recordBuffer,
+                          QDateTime::currentMSecsSinceEpoch() * 1000,
+                          isBinary, data, size);
+    if (recordBuffer.size() >= RECORD_FLUSH_SIZE) flushRecording();
+}
+
+/*!
+ * \brief Sets the receive time of samples and parses their time fields
+ *
+ * \param batch: Samples of a received message
+ */
+void IngestionWorker::stamp(QVector<Sample> &batch) {
+    qint64 received = QDateTime::currentMSecsSinceEpoch() * 1000;
+    for (Sample &sample : batch) {
+        sample.received = received;
+        if (!sample.timestamp) sample.timestamp = timeParser.parse(sample.time);
+        qualify(sample.name);
+    }
+}
+
+/*!
+ * \brief Prepends the source prefix to a parameter name
+ *
+ * Qualified names are cached, so that repeated names share one string
+ * instead of being concatenated per sample. Empty names and latency
+ * probes are left unchanged.
+ *
+ * \param name: Received parameter name
+ */
+void IngestionWorker::qualify(QString &name) {
+    if (prefix.isEmpty() || name.isEmpty() || name == PROBE_NAME) return;
+    QHash<QString, QString>::const_iterator it = qualifiedNames.constFind(name);
+    if (it == qualifiedNames.constEnd()) {
+        if (qualifiedNames.size() >= QUALIFIED_NAMES_MAX) {
+            qualifiedNames.clear();
+        }
+        it = qualifiedNames.insert(name, prefix + name);
+    }
+    name = it.value();
+}
+
+/*!
+ * \brief Appends the samples of a message to the queue
+ * and notifies the GUI thread
+ *
+ * The samples of a batch become visible to the GUI thread at once.
+ * The GUI thread is notified only once until it has drained the queue.
+ * Samples are dropped instead of blocking when the queue is full,
+ * except at maximum replay speed, where the replay is paused instead.
+ *
+ * \param batch: Decoded samples
+ */
+void IngestionWorker::publish(const QVector<Sample> &batch) {
+    if (batch.isEmpty()) return;
+    size_t pushed = queue->push(batch.constData(), batch.size());
+    if (pushed < size_t(batch.size())) {
+        dropped.fetch_add(batch.size() - pushed, std::memory_order_relaxed);
+    }
+    if (queue->requestNotify()) emit samplesReady();
+    if (replayer && replaySpeed == 0 && queue->size() >= REPLAY_QUEUE_HIGH) {
+        replayer->pause();
+    }
+}
+
+/*!
+ * \brief Schedules the next automatic connection attempt
+ *
+ * The first attempt after losing a connection is immediate. Each failed
+ * attempt doubles the delay from \b RECONNECT_DELAY_MIN up to
+ * \b RECONNECT_DELAY_MAX, randomized by \b RECONNECT_JITTER so that
+ * many screens do not reconnect to a restarted server at once.
+ */
+void IngestionWorker::scheduleReconnect() {
+    if (!autoConnect || uri.isEmpty() || reconnectTimer->isActive()) return;
+
+    int delay = 0;
+    if (attempts > 0) {
+        delay = RECONNECT_DELAY_MAX;
+        if (attempts < 16) {
+            delay = qMin(RECONNECT_DELAY_MIN << (attempts - 1),
+                         RECONNECT_DELAY_MAX);
+        }
+        double jitter = (QRandomGenerator::global()->generateDouble() * 2 - 1)
+                        * RECONNECT_JITTER;
+        delay = int(delay * (1 + jitter));
+    }
+    attempts++;
+    reconnectTimer->start(delay);
+}
+
+/*!
+ * \brief Opens the connection if automatic connection is enabled
+ */
+void IngestionWorker::reconnect() {
+    if (socket->state() == QAbstractSocket::UnconnectedState
+            && !uri.isEmpty() && autoConnect) socket->open(uri);
+}
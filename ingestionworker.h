@@ -0,0 +1,112 @@
+/*!
+ * \file ingestionworker.h
+ */
+#ifndef INGESTIONWORKER_H
+#define INGESTIONWORKER_H
+
+#include <QObject>
+#include <QUrl>
+#include <QWebSocket>
+#include <QTimer>
+#include <QHash>
+#include <atomic>
+#include "sample.h"
+#include "samplequeue.h"
+#include "messagedecoder.h"
+#include "binaryprotocol.h"
+#include "subscription.h"
+#include "performancestats.h"
+#include "timeparser.h"
+#include "recorder.h"
+#include "replayer.h"
+
+const int RECONNECT_DELAY_MIN = 250; /*!< Delay before the first reconnection
+                                          attempt after a failure in ms */
+const int RECONNECT_DELAY_MAX = 30000; /*!< Longest reconnection delay in ms */
+const double RECONNECT_JITTER = 0.2; /*!< Reconnection delays are randomized
+                                          by up to this share */
+const size_t REPLAY_QUEUE_HIGH = SAMPLE_QUEUE_CAPACITY / 2; /*!< Queued
+            samples pausing a replay at maximum speed */
+const int QUALIFIED_NAMES_MAX = 65536; /*!< Cached qualified names, the cache
+                                            is emptied when exceeded */
+
+/*!
+ * \brief IngestionWorker class
+ *
+ * Owns the WebSocket connection and decodes received messages on
+ * a dedicated thread. Decoded samples are handed to the GUI thread
+ * through a lock-free queue, so a busy or blocked GUI never stalls
+ * the network path. With several sources each one has its own worker,
+ * thread and queue, and parameter names are qualified with a source
+ * prefix on the worker thread. Received messages can be recorded and
+ * a recording can be replayed in place of a connection.
+ */
+class IngestionWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit IngestionWorker(SampleQueue<Sample> *queue,
+                             const QString &prefix = "", QObject *parent = 0);
+
+    quint64 droppedCount() const;
+    IngestionStats &stats();
+    void setRecorder(Recorder *newRecorder);
+
+signals:
+    void connected();
+    void disconnected();
+    void samplesReady();
+    void catalogReceived(QStringList names);
+    void replayFinished(quint64 count);
+
+public slots:
+    void start();
+    void open(QUrl newUri);
+    void closeConnection();
+    void subscribe(QStringList names);
+    void send(QString message);
+    void messageReceived(QString message);
+    void binaryMessageReceived(QByteArray message);
+    void replay(QString path, double speed);
+    void resumeReplay();
+    void flushRecording();
+
+private slots:
+    void socketConnected();
+    void socketDisconnected();
+    void socketError(QAbstractSocket::SocketError error);
+    void reconnect();
+
+private:
+    void stamp(QVector<Sample> &batch);
+    void qualify(QString &name);
+    void publish(const QVector<Sample> &batch);
+    void scheduleReconnect();
+    void record(bool isBinary, const char *data, int size);
+
+    SampleQueue<Sample> *queue; /*!< Queue shared with the GUI thread */
+    QWebSocket *socket; /*!< Current WebSocket object */
+    MessageDecoder decoder; /*!< Decodes received text messages */
+    BinaryDecoder binaryDecoder; /*!< Decodes received binary messages */
+    TimeParser timeParser; /*!< Parses the time fields of text messages */
+    QVector<Sample> samples; /*!< Reused for the samples of each message */
+    QStringList subscription; /*!< Subscribed names, empty for all */
+    QStringList catalog; /*!< Reused for received catalogs */
+    QString prefix; /*!< Prepended to received parameter names */
+    QHash<QString, QString> qualifiedNames; /*!< Qualified name of each
+                                                 received name */
+    QUrl uri; /*!< WebSocket URI */
+    bool autoConnect; /*!< Determines, whether the worker should try
+                           connecting to a WebSocket server automatically */
+    QTimer *reconnectTimer; /*!< Single shot timer for reconnecting */
+    int attempts; /*!< Failed connection attempts since the last success */
+    Recorder *recorder; /*!< Writes the recording, 0 if not recording */
+    QByteArray recordBuffer; /*!< Frames not yet handed to the recorder */
+    QTimer *recordTimer; /*!< Hands buffered frames to the recorder */
+    Replayer *replayer; /*!< Replays a recording, 0 if not replaying */
+    double replaySpeed; /*!< Speed factor of the replay, 0 for maximum */
+    IngestionStats ingestionStats; /*!< Counters read by the GUI thread */
+    std::atomic<quint64> dropped; /*!< Number of samples dropped due to a full queue */
+};
+
+#endif // INGESTIONWORKER_H
@@ -0,0 +1,95 @@
+/*!
+ * \file latencyhistogram.cpp
+ */
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <limits>
+
+/*!
+ * \brief LatencyHistogram constructor
+ */
+LatencyHistogram::LatencyHistogram() : total(0), largest(0) {}
+
+/*!
+ * \brief Counts a latency
+ *
+ * \param latency: Latency in microseconds, negative values
+ * caused by clock differences are counted as 0
+ */
+void LatencyHistogram::record(qint64 latency) {
+    if (latency < 0) latency = 0;
+    if (buckets.isEmpty()) buckets.fill(0, LATENCY_BUCKETS);
+    quint32 &bucket = buckets[bucketOf(latency)];
+    if (bucket < std::numeric_limits<quint32>::max()) bucket++;
+    total++;
+    if (latency > largest) largest = latency;
+}
+
+/*!
+ * \brief Removes all latencies and frees the buckets
+ */
+void LatencyHistogram::clear() {
+    buckets.clear();
+    buckets.squeeze();
+    total = 0;
+    largest = 0;
+}
+
+/*!
+ * \brief Returns the number of recorded latencies
+ */
+quint64 LatencyHistogram::count() const {
+    return total;
+}
+
+/*!
+ * \brief Returns the latency below which a share of latencies fall
+ *
+ * \param share: Share between 0 and 1, e.g. 0.99
+ * \return Upper limit of the bucket holding the percentile in
+ * microseconds, at most the largest latency, 0 if empty
+ */
+qint64 LatencyHistogram::percentile(double share) const {
+    if (!total) return 0;
+    quint64 rank = quint64(share * total);
+    if (rank >= total) rank = total - 1;
+
+    quint64 seen = 0;
+    for (int i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen > rank) return qMin(bucketLimit(i), largest);
+    }
+    return largest;
+}
+
+/*!
+ * \brief Returns the largest recorded latency
+ */
+qint64 LatencyHistogram::maximum() const {
+    return largest;
+}
+
+/*!
+ * \brief Returns the bucket of a latency
+ *
+ * Latencies below \b LATENCY_SUB_BUCKETS have a bucket of their own,
+ * each larger power of two is split into \b LATENCY_SUB_BUCKETS
+ * linear buckets
+ */
+int LatencyHistogram::bucketOf(qint64 latency) {
+    if (latency < LATENCY_SUB_BUCKETS) return int(latency);
+    int exponent = 63 - int(qCountLeadingZeroBits(quint64(latency)));
+    if (exponent >= LATENCY_EXPONENT_MAX) return LATENCY_BUCKETS - 1;
+    int sub = int(latency >> (exponent - 2)) - LATENCY_SUB_BUCKETS;
+    return LATENCY_SUB_BUCKETS * (exponent - 1) + sub;
+}
+
+/*!
+ * \brief Returns the largest latency of a bucket
+ */
+qint64 LatencyHistogram::bucketLimit(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) return bucket;
+    int exponent = bucket / LATENCY_SUB_BUCKETS + 1;
+    int sub = bucket % LATENCY_SUB_BUCKETS;
+    return ((qint64(LATENCY_SUB_BUCKETS + sub + 1)) << (exponent - 2)) - 1;
+}
@@ -0,0 +1,43 @@
+/*!
+ * \file latencyhistogram.h
+ */
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QVector>
+
+const int LATENCY_SUB_BUCKETS = 4; /*!< Linear buckets per power of two,
+                                        bounds the relative error to 25% */
+const int LATENCY_EXPONENT_MAX = 36; /*!< Latencies from 2^36 us, about
+                                          19 hours, share the last bucket */
+const int LATENCY_BUCKETS = LATENCY_SUB_BUCKETS * (LATENCY_EXPONENT_MAX - 1);
+/*!< Number of buckets of a histogram */
+
+/*!
+ * \brief LatencyHistogram class
+ *
+ * Counts latencies in microseconds in log-linear buckets of fixed
+ * memory, as in HDR histograms. Buckets are allocated on the first
+ * recorded latency.
+ */
+class LatencyHistogram {
+
+public:
+    LatencyHistogram();
+
+    void record(qint64 latency);
+    void clear();
+    quint64 count() const;
+    qint64 percentile(double share) const;
+    qint64 maximum() const;
+
+private:
+    static int bucketOf(qint64 latency);
+    static qint64 bucketLimit(int bucket);
+
+    QVector<quint32> buckets; /*!< Number of latencies in each bucket */
+    quint64 total; /*!< Number of recorded latencies */
+    qint64 largest; /*!< Largest recorded latency */
+};
+
+#endif // LATENCYHISTOGRAM_H
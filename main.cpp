@@ -2,15 +2,75 @@
  * \file main.cpp
  */
 #include "monitorwindow.h"
+#include "relayserver.h"
+#include <QCommandLineParser>
 /*!
  * \brief Main function
+ *
+ * Connects to the sources stored in QSettings \b URIS_SETTING,
+ * or to the single one stored by earlier versions. With \b REPLAY_OPTION
+ * the given recordings are replayed instead. With \b RELAY_OPTION no
+ * window is created and the sources are relayed to other screens, the
+ * sources may also be given as arguments.
  */
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+    bool relay = false;
+    for (int i = 1; i < argc; i++) {
+        if (QString(argv[i]) == "--" + RELAY_OPTION) relay = true;
+    }
+    QScopedPointer<QCoreApplication> app(relay
+            ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
     QCoreApplication::setOrganizationName(ORGANIZATION);
     QCoreApplication::setApplicationName(APP_NAME);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption(REPLAY_OPTION, REPLAY_OPTION_TEXT,
+                                        "segment"));
+    parser.addOption(QCommandLineOption(SPEED_OPTION, SPEED_OPTION_TEXT,
+                                        "speed", "1"));
+    parser.addOption(QCommandLineOption(RELAY_OPTION, RELAY_OPTION_TEXT));
+    parser.addOption(QCommandLineOption(PORT_OPTION, PORT_OPTION_TEXT,
+                                    "port", QString::number(RELAY_PORT)));
+    parser.addOption(QCommandLineOption(RATE_OPTION, RATE_OPTION_TEXT,
+                                    "rate", QString::number(RELAY_RATE)));
+    parser.addPositionalArgument("uris", URIS_ARGUMENT_TEXT, "[uris...]");
+    parser.process(*app);
+
+    QStringList replays = parser.values(REPLAY_OPTION);
+    if (!relay && !replays.isEmpty()) {
+        QString speedText = parser.value(SPEED_OPTION).toLower();
+        if (speedText.endsWith('x')) speedText.chop(1);
+        bool validSpeed = true;
+        double speed = speedText == SPEED_MAX ? 0
+                                              : speedText.toDouble(&validSpeed);
+        if (speedText != SPEED_MAX && (!validSpeed || speed <= 0)) speed = 1;
+        MonitorWindow window;
+        window.openReplay(replays, speed);
+        window.show();
+        return app->exec();
+    }
+
     QSettings settings;
-    MonitorWindow window(QUrl(settings.value(URI_SETTING).toString()));
+    QStringList stored = parser.positionalArguments();
+    if (stored.isEmpty()) {
+        stored = settings.contains(URIS_SETTING)
+                ? settings.value(URIS_SETTING).toStringList()
+                : QStringList(settings.value(URI_SETTING).toString());
+    }
+    QList<QUrl> uris;
+    for (const QString &uri : stored) {
+        if (uri != "") uris << QUrl(uri);
+    }
+
+    if (relay) {
+        RelayServer server;
+        if (!server.listen(quint16(parser.value(PORT_OPTION).toUInt()),
+                           parser.value(RATE_OPTION).toInt())) return 1;
+        server.openSources(uris);
+        return app->exec();
+    }
+    MonitorWindow window(uris);
     window.show();
-    return app.exec();
+    return app->exec();
 }
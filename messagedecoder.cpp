@@ -0,0 +1,319 @@
+/*!
+ * \file messagedecoder.cpp
+ */
+#include "messagedecoder.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include "valueparser.h"
+
+namespace {
+
+/*!
+ * \brief Skips JSON whitespace
+ *
+ * \param p: Current position
+ * \param end: End of the message
+ * \return First non-whitespace position
+ */
+const QChar *skipSpace(const QChar *p, const QChar *end) {
+    while (p < end && (p->unicode() == ' ' || p->unicode() == '\t'
+                    || p->unicode() == '\n' || p->unicode() == '\r')) p++;
+    return p;
+}
+
+/*!
+ * \brief Checks if the current position holds a character
+ *
+ * \param p: Current position
+ * \param end: End of the message
+ * \param c: Expected character
+ * \return True: Character found
+ */
+bool isAt(const QChar *p, const QChar *end, char c) {
+    return p < end && p->unicode() == c;
+}
+
+/*!
+ * \brief Reads a JSON string without escape sequences
+ *
+ * \param p: Position of the opening quote, moved past the closing quote
+ * \param end: End of the message
+ * \param string: Receives the string contents
+ * \return True: String was read, false: string is malformed or escaped
+ */
+bool readString(const QChar *&p, const QChar *end, QStringView &string) {
+    if (!isAt(p, end, '"')) return false;
+    const QChar *start = ++p;
+
+    while (p < end && p->unicode() != '"') {
+        if (p->unicode() == '\\') return false;
+        p++;
+    }
+    if (p == end) return false;
+    string = QStringView(start, p - start);
+    p++;
+    return true;
+}
+
+/*!
+ * \brief Reads a flat object of parameter names and string values
+ *
+ * \param p: Position of the opening brace, moved past the closing brace
+ * \param end: End of the message
+ * \param views: Receives a view for each parameter
+ * \return True: Object was read
+ */
+bool readValues(const QChar *&p, const QChar *end,
+                QVector<MessageView> &views) {
+    if (!isAt(p, end, '{')) return false;
+    p = skipSpace(p + 1, end);
+    if (isAt(p, end, '}')) {
+        p++;
+        return true;
+    }
+
+    while (true) {
+        MessageView view;
+        if (!readString(p, end, view.name)) return false;
+        p = skipSpace(p, end);
+        if (!isAt(p, end, ':')) return false;
+        p = skipSpace(p + 1, end);
+        if (!readString(p, end, view.value)) return false;
+        views.append(view);
+
+        p = skipSpace(p, end);
+        if (isAt(p, end, '}')) break;
+        if (!isAt(p, end, ',')) return false;
+        p = skipSpace(p + 1, end);
+    }
+    p++;
+    return true;
+}
+
+/*!
+ * \brief Reads a single message object or a batch object
+ *
+ * \param p: Position of the opening brace, moved past the closing brace
+ * \param end: End of the message
+ * \param view: Receives the fields of a single message
+ * \param batch: Receives the parameters of a \b JSON_VALUES batch,
+ *               batches are rejected if null
+ * \return True: Object was read
+ */
+bool readObject(const QChar *&p, const QChar *end, MessageView &view,
+                QVector<MessageView> *batch) {
+    if (!isAt(p, end, '{')) return false;
+    p = skipSpace(p + 1, end);
+    view = MessageView();
+    int batchStart = batch ? batch->size() : 0;
+    bool isBatch = false;
+
+    if (isAt(p, end, '}')) {
+        p++;
+        return true;
+    }
+
+    while (true) {
+        QStringView key, value;
+        if (!readString(p, end, key)) return false;
+        p = skipSpace(p, end);
+        if (!isAt(p, end, ':')) return false;
+        p = skipSpace(p + 1, end);
+
+        if (batch && !isBatch && key == QStringView(JSON_VALUES)) {
+            if (!readValues(p, end, *batch)) return false;
+            isBatch = true;
+        }
+        else {
+            if (!readString(p, end, value)) return false;
+
+            if (key == QStringView(JSON_NAME)) view.name = value;
+            else if (key == QStringView(JSON_VALUE)) view.value = value;
+            else if (key == QStringView(JSON_TIME)) view.time = value;
+            else return false;
+        }
+
+        p = skipSpace(p, end);
+        if (isAt(p, end, '}')) break;
+        if (!isAt(p, end, ',')) return false;
+        p = skipSpace(p + 1, end);
+    }
+    p++;
+
+    if (isBatch) {
+        if (!view.name.isEmpty() || !view.value.isEmpty()) return false;
+        for (int i = batchStart; i < batch->size(); i++) {
+            (*batch)[i].time = view.time;
+        }
+    }
+    else if (batch) batch->append(view);
+    return true;
+}
+
+} // namespace
+
+/*!
+ * \brief Decodes a single message or a batch, trying the fast path first
+ *
+ * A message that is not a JSON object or array yields one empty sample
+ *
+ * \param message: Received message
+ * \param samples: Receives the decoded samples
+ */
+void MessageDecoder::decode(const QString &message, QVector<Sample> &samples) {
+    views.clear();
+    if (!decodeFast(message, views)) {
+        decodeJson(message, samples);
+        return;
+    }
+
+    for (const MessageView &view : views) {
+        Sample sample;
+        sample.name = view.name.toString();
+        sample.value = view.value.toString();
+        sample.time = view.time.toString();
+        sample.hasNumber = ValueParser::parse(view.value, sample.number);
+        samples.append(sample);
+    }
+}
+
+/*!
+ * \brief Decodes a single message, trying the fast path first
+ *
+ * \param message: Received message
+ * \param sample: Receives the decoded fields
+ * \return True: Message was a JSON object
+ */
+bool MessageDecoder::decode(const QString &message, Sample &sample) {
+    MessageView view;
+    if (!decodeFast(message, view)) return decodeJson(message, sample);
+
+    sample.name = view.name.toString();
+    sample.value = view.value.toString();
+    sample.time = view.time.toString();
+    sample.hasNumber = ValueParser::parse(view.value, sample.number);
+    return true;
+}
+
+/*!
+ * \brief Decodes a single message with one scan and no heap allocation
+ *
+ * Accepts only flat objects whose fields are \b JSON_NAME, \b JSON_VALUE
+ * and \b JSON_TIME with unescaped string values. Missing fields are left
+ * empty. Anything else is rejected and should be handled by decodeJson().
+ *
+ * \param message: Received message
+ * \param view: Receives views into the message
+ * \return True: Message was decoded
+ */
+bool MessageDecoder::decodeFast(QStringView message, MessageView &view) {
+    const QChar *p = message.data();
+    const QChar *end = p + message.size();
+
+    p = skipSpace(p, end);
+    if (!readObject(p, end, view, 0)) return false;
+    return skipSpace(p, end) == end;
+}
+
+/*!
+ * \brief Decodes a single message or a batch with one scan
+ *
+ * In addition to single messages, accepts arrays of them and objects
+ * with a shared \b JSON_TIME and a \b JSON_VALUES object of names and
+ * values. Views are appended to the vector, which allocates only when
+ * it has to grow.
+ *
+ * \param message: Received message
+ * \param views: Receives views into the message
+ * \return True: Message was decoded
+ */
+bool MessageDecoder::decodeFast(QStringView message,
+                                QVector<MessageView> &views) {
+    const QChar *p = message.data();
+    const QChar *end = p + message.size();
+    MessageView view;
+    p = skipSpace(p, end);
+
+    if (isAt(p, end, '[')) {
+        p = skipSpace(p + 1, end);
+
+        while (!isAt(p, end, ']')) {
+            if (!readObject(p, end, view, 0)) return false;
+            views.append(view);
+            p = skipSpace(p, end);
+            if (isAt(p, end, ',')) {
+                p = skipSpace(p + 1, end);
+                if (isAt(p, end, ']')) return false;
+            }
+            else if (!isAt(p, end, ']')) return false;
+        }
+        p++;
+    }
+    else if (!readObject(p, end, view, &views)) return false;
+    return skipSpace(p, end) == end;
+}
+
+/*!
+ * \brief Decodes a single message using QJsonDocument
+ *
+ * Used for messages the fast path does not accept
+ *
+ * \param message: Received message
+ * \param sample: Receives the decoded fields
+ * \return True: Message was a JSON object
+ */
+bool MessageDecoder::decodeJson(const QString &message, Sample &sample) {
+    QJsonDocument jsonMessage = QJsonDocument::fromJson(message.toUtf8());
+    QJsonObject jsonObject = jsonMessage.object();
+    sample.name = jsonObject[JSON_NAME].toString();
+    sample.value = jsonObject[JSON_VALUE].toString();
+    sample.time = jsonObject[JSON_TIME].toString();
+    sample.hasNumber = ValueParser::parse(sample.value, sample.number);
+    return jsonMessage.isObject();
+}
+
+/*!
+ * \brief Decodes a single message or a batch using QJsonDocument
+ *
+ * \param message: Received message
+ * \param samples: Receives the decoded samples
+ */
+void MessageDecoder::decodeJson(const QString &message,
+                                QVector<Sample> &samples) {
+    QJsonDocument jsonMessage = QJsonDocument::fromJson(message.toUtf8());
+
+    if (jsonMessage.isArray()) {
+        for (const QJsonValue &jsonValue : jsonMessage.array()) {
+            appendJson(jsonValue.toObject(), samples);
+        }
+    }
+    else appendJson(jsonMessage.object(), samples);
+}
+
+/*!
+ * \brief Appends the samples of a single message or batch object
+ *
+ * \param jsonObject: Message object
+ * \param samples: Receives the decoded samples
+ */
+void MessageDecoder::appendJson(const QJsonObject &jsonObject,
+                                QVector<Sample> &samples) {
+    Sample sample;
+    sample.time = jsonObject[JSON_TIME].toString();
+
+    if (jsonObject[JSON_VALUES].isObject()) {
+        QJsonObject values = jsonObject[JSON_VALUES].toObject();
+        for (QJsonObject::const_iterator it = values.constBegin();
+             it != values.constEnd(); ++it) {
+            sample.name = it.key();
+            sample.value = it.value().toString();
+            sample.hasNumber = ValueParser::parse(sample.value, sample.number);
+            samples.append(sample);
+        }
+        return;
+    }
+    sample.name = jsonObject[JSON_NAME].toString();
+    sample.value = jsonObject[JSON_VALUE].toString();
+    sample.hasNumber = ValueParser::parse(sample.value, sample.number);
+    samples.append(sample);
+}
@@ -0,0 +1,54 @@
+/*!
+ * \file messagedecoder.h
+ */
+#ifndef MESSAGEDECODER_H
+#define MESSAGEDECODER_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QJsonObject>
+#include "sample.h"
+
+const QString JSON_NAME = "name"; /*!< JSON field for parameter name */
+const QString JSON_VALUE = "value"; /*!< JSON field for parameter value */
+const QString JSON_TIME = "time"; /*!< JSON field for message timestamp */
+const QString JSON_VALUES = "values"; /*!< JSON field for a batch of
+                                           parameter names and values */
+
+/*!
+ * \brief Fields of a message decoded by the fast path
+ *
+ * Views point into the decoded message and are valid as long as it is
+ */
+struct MessageView {
+    QStringView name; /*!< Parameter name */
+    QStringView value; /*!< Parameter value */
+    QStringView time; /*!< Message timestamp */
+};
+
+/*!
+ * \brief MessageDecoder class
+ *
+ * Decodes single messages of the form
+ * {"name":"...","value":"...","time":"..."} and batches of them, either
+ * as an array of such objects or as {"time":"...","values":{"...":"..."}}
+ */
+class MessageDecoder {
+
+public:
+    void decode(const QString &message, QVector<Sample> &samples);
+    static bool decode(const QString &message, Sample &sample);
+    static bool decodeFast(QStringView message, MessageView &view);
+    static bool decodeFast(QStringView message, QVector<MessageView> &views);
+    static bool decodeJson(const QString &message, Sample &sample);
+    static void decodeJson(const QString &message, QVector<Sample> &samples);
+
+private:
+    static void appendJson(const QJsonObject &jsonObject,
+                           QVector<Sample> &samples);
+
+    QVector<MessageView> views; /*!< Reused for decoding batches */
+};
+
+#endif // MESSAGEDECODER_H
@@ -6,9 +6,12 @@
 
 /*!
  * \brief MonitorWindow constructor
+ *
+ * \param quris: WebSocket URIs of the sources
  */
-MonitorWindow::MonitorWindow(QUrl quri, QWidget *parent) : uri(quri),
-    QMainWindow(parent), ui(new Ui::MonitorWindow) {
+MonitorWindow::MonitorWindow(const QList<QUrl> &quris, QWidget *parent) :
+    QMainWindow(parent), ui(new Ui::MonitorWindow),
+    fitter(TEXT_LENGTH_MIN, SIZE_PERCENTAGE) {
 
     ui->setupUi(this);
     ui->actionDisconnect->setEnabled(false);
@@ -20,39 +23,396 @@ MonitorWindow::MonitorWindow(QUrl quri, QWidget *parent) : uri(quri),
     parameterLayout = new QBoxLayout(QBoxLayout::TopToBottom);
     layout->addLayout(parameterLayout);
     centralWidget()->setLayout(layout);
-    windowSize = rect().size();
     statusBar()->showMessage(DISCONNECTED_TEXT);
 
-    QObject::connect(&socket, SIGNAL(connected()), this, SLOT(connected()));
-    QObject::connect(&socket, SIGNAL(disconnected()), this,
-                                                SLOT(disconnected()));
-    QObject::connect(&socket, SIGNAL(textMessageReceived(QString)), this,
-                                                SLOT(messageReceived(QString)));
-
-    text = new QLabel(this);
-    text->setAlignment(Qt::AlignCenter);
-    layout->addWidget(text);
+    selectedId = -1;
+    displayedId = -1;
+    statusChanged = false;
+    statusTimestamp = 0;
+    text = new ValueView(this);
+    chart = new TrendChart(this);
+    chart->setWindow(settings.value(TREND_WINDOW_SETTING, TREND_WINDOW)
+                                                            .toLongLong());
+    chart->setFixedHeight(int(rect().height() * TREND_HEIGHT_RATIO));
+    chart->hide();
+    valueLayout = new QBoxLayout(QBoxLayout::TopToBottom);
+    aggregateLabel = new QLabel(this);
+    aggregateLabel->setStyleSheet(AGGREGATE_STYLE);
+    aggregateLabel->setAlignment(Qt::AlignCenter);
+    aggregateLabel->hide();
+    QObject::connect(&aggregateTimer, SIGNAL(timeout()), this,
+                                            SLOT(updateAggregates()));
+    aggregateAll = settings.value(AGGREGATE_ALL_SETTING, true).toBool();
+    valueLayout->addWidget(text);
+    valueLayout->addWidget(aggregateLabel);
+    valueLayout->addWidget(chart);
+    dashboard = new Dashboard(this);
+    dashboard->setMaximumTiles(settings.value(GRID_TILES_SETTING, GRID_TILES)
+                                                                .toInt());
+    dashboard->hide();
+    QObject::connect(dashboard, SIGNAL(tileClicked(int)), this,
+                                                SLOT(tileClicked(int)));
+    valueLayout->addWidget(dashboard);
+    layout->addLayout(valueLayout);
     createParameterList();
 
+    history.setBudget(settings.value(HISTORY_MEMORY_SETTING, HISTORY_MEMORY)
+                                                .toLongLong() * HISTORY_MIB);
+    ui->actionTrend_chart->setChecked(settings.value(TREND_SETTING, true)
+                                                            .toBool());
+    chartId = -1;
+    receiveClock.start();
+
     QShortcut *deleteShortcut = new QShortcut(QKeySequence(DELETE_SHORTCUT),
                                                                         this);
     QObject::connect(deleteShortcut, SIGNAL(activated()), this,
                                         SLOT(parameterDeleted()));
 
-    QTimer *timer = new QTimer(this);
-    QObject::connect(timer, SIGNAL(timeout()), this, SLOT(update()));
-    timer->start(TICK_LENGTH);
-    autoConnect = true;
+    mergedLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(mergedLabel);
+    frameDirty = false;
+    mergedUpdates = 0;
+    frameInterval = settings.value(FRAME_INTERVAL_SETTING, 0).toInt();
+
+    staleLabel = new QLabel(this);
+    staleLabel->setStyleSheet("color: " + STALE_COLOR.name() + ";");
+    staleLabel->hide();
+    statusBar()->addPermanentWidget(staleLabel);
+    isStale = false;
+    staleThreshold = settings.value(STALE_THRESHOLD_SETTING, STALE_THRESHOLD)
+                                                    .toLongLong() * 1000;
+    staleTimer.setSingleShot(true);
+    QObject::connect(&staleTimer, SIGNAL(timeout()), this,
+                                            SLOT(checkStale()));
+
+    alarms.load(settings);
+    QString alarmFile = settings.value(ALARM_FILE_SETTING).toString();
+    if (alarmFile != "") {
+        QSettings alarmSettings(alarmFile, QSettings::IniFormat);
+        alarms.load(alarmSettings);
+    }
+    alarmLabel = new QLabel(this);
+    alarmLabel->setStyleSheet("color: " + ALARM_COLOR.name() + ";");
+    alarmLabel->hide();
+    statusBar()->addPermanentWidget(alarmLabel);
+    flashOn = false;
+    QObject::connect(&alarmTimer, SIGNAL(timeout()), this,
+                                            SLOT(checkAlarms()));
+    QObject::connect(&flashTimer, SIGNAL(timeout()), this,
+                                            SLOT(flashAlarm()));
+    if (alarms.ruleCount()) alarmTimer.start(ALARM_CHECK_INTERVAL);
+
+    if (frameInterval <= 0) {
+        qreal refreshRate = QGuiApplication::primaryScreen() ?
+                    QGuiApplication::primaryScreen()->refreshRate() : 0;
+        frameInterval = refreshRate > 0 ? int(1000 / refreshRate)
+                                        : FRAME_INTERVAL;
+    }
+    frameTimer.setSingleShot(true);
+    frameClock.start();
+    QObject::connect(&frameTimer, SIGNAL(timeout()), this,
+                                            SLOT(renderFrame()));
+
+    overlay = new QLabel(this);
+    overlay->setStyleSheet(OVERLAY_STYLE);
+    overlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+    overlay->hide();
+    statsFile = settings.value(STATS_FILE_SETTING).toString();
+    QObject::connect(&statsTimer, SIGNAL(timeout()), this,
+                                            SLOT(updateStats()));
+    ui->actionPerformance_overlay->setChecked(
+                settings.value(OVERLAY_SETTING, false).toBool());
+    on_actionPerformance_overlay_triggered(
+                ui->actionPerformance_overlay->isChecked());
+
+    ui->actionGrid_mode->setChecked(settings.value(GRID_SETTING, false)
+                                                            .toBool());
+    replaying = false;
+    writerThread = new QThread(this);
+    writerThread->start();
+    snapshot = 0;
+    snapshotDirty = false;
+    restoreSnapshot();
+    addAlarmParameters();
+    on_actionGrid_mode_triggered(ui->actionGrid_mode->isChecked());
+
+    openSources(quris);
 }
 
 /*!
  * \brief MonitorWindow destructor
+ *
+ * The final snapshot is written directly once the writer thread
+ * has stopped
  */
 MonitorWindow::~MonitorWindow() {
-    closeConnection();
+    closeSources();
+    writerThread->quit();
+    writerThread->wait();
+    if (snapshot) {
+        if (snapshotDirty && !replaying) snapshot->write(encodeSnapshot());
+        delete snapshot;
+    }
     delete ui;
 }
 
+/*!
+ * \brief Connects to a list of sources
+ *
+ * Each source gets its own ingestion worker, thread and sample queue,
+ * so sources never wait for each other. With several sources parameter
+ * names are qualified with the source, see sourcePrefix(). Sources
+ * already connected to the same URIs are reconnected instead.
+ *
+ * If QSettings \b RECORD_DIRECTORY_SETTING is set, the messages of each
+ * source are recorded there, see recorder.h
+ *
+ * \param newUris: WebSocket URIs
+ */
+void MonitorWindow::openSources(const QList<QUrl> &newUris) {
+    if (newUris == uris && sources.size() == uris.size() && !replaying) {
+        for (const IngestionSource &source : sources) {
+            QMetaObject::invokeMethod(source.worker, "open",
+                        Qt::QueuedConnection, Q_ARG(QUrl, source.uri));
+        }
+        return;
+    }
+    closeSources();
+    uris = newUris;
+    replaying = false;
+    subscription.clear();
+
+    QString directory = settings.value(RECORD_DIRECTORY_SETTING).toString();
+    QString started = QDateTime::currentDateTime().toString(RECORD_TIME_FORMAT);
+    for (int i = 0; i < uris.size(); i++) {
+        Recorder *recorder = 0;
+        if (directory != "") {
+            recorder = new Recorder(QDir(directory).filePath(started + "-"
+                                        + QString::number(i)), uris[i]);
+            recorder->moveToThread(writerThread);
+        }
+        addSource(uris[i], uris.size() > 1 ? sourcePrefix(uris[i]) : "",
+                  recorder);
+        QMetaObject::invokeMethod(sources.last().worker, "open",
+                        Qt::QueuedConnection, Q_ARG(QUrl, uris[i]));
+    }
+    sendSubscription();
+}
+
+/*!
+ * \brief Shows the state stored by an earlier run
+ *
+ * Parameters are listed with their last values and receive times and
+ * flagged with \b PARAM_RESTORED, so they are shown as stale until they
+ * are received again. Snapshots are written to the file set in QSettings
+ * \b SNAPSHOT_FILE_SETTING \b SNAPSHOT_INTERVAL after the state has
+ * changed, and on exit.
+ */
+void MonitorWindow::restoreSnapshot() {
+    QString path = settings.value(SNAPSHOT_FILE_SETTING,
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+            + "/" + SNAPSHOT_FILE_NAME).toString();
+    if (path == "") return;
+    snapshot = new StateSnapshot(path);
+    snapshot->moveToThread(writerThread);
+    snapshotTimer.setSingleShot(true);
+    snapshotTimer.setInterval(SNAPSHOT_INTERVAL);
+    QObject::connect(&snapshotTimer, SIGNAL(timeout()), this,
+                                            SLOT(saveSnapshot()));
+
+    SnapshotState state;
+    if (!StateSnapshot::load(path, state)) return;
+    for (const Sample &sample : state.samples) {
+        if (sample.name == "") continue;
+        bool added;
+        int id = registry.intern(sample.name, &added);
+        if (added) addParameter(id, sample.name);
+        registry.update(id, sample);
+        registry.slot(id).flags |= PARAM_RESTORED;
+        dashboard->markChanged(id);
+    }
+    ui->actionGrid_mode->setChecked(state.gridMode);
+    if (registry.find(state.selected) >= 0) parameterSelected(state.selected);
+}
+
+/*!
+ * \brief Notes a change of the state and schedules a snapshot
+ *
+ * The timer is only started by the first change after a snapshot,
+ * so an unchanged state causes no wakeups
+ */
+void MonitorWindow::markSnapshotDirty() {
+    if (!snapshotDirty && snapshot) snapshotTimer.start();
+    snapshotDirty = true;
+}
+
+/*!
+ * \brief Hands a snapshot of the state to the writer thread
+ * if it has changed
+ *
+ * Replayed recordings are not stored
+ */
+void MonitorWindow::saveSnapshot() {
+    if (!snapshot || !snapshotDirty || replaying) return;
+    snapshotDirty = false;
+    QMetaObject::invokeMethod(snapshot, "write", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, encodeSnapshot()));
+}
+
+/*!
+ * \brief Encodes the parameters, the selection and the window mode
+ *
+ * \return Snapshot in the format of statesnapshot.h
+ */
+QByteArray MonitorWindow::encodeSnapshot() const {
+    QString selected = selectedId >= 0 ? registry.slot(selectedId).name : "";
+    return StateSnapshot::encode(registry, selected,
+                                 ui->actionGrid_mode->isChecked());
+}
+
+/*!
+ * \brief Replays recordings instead of connecting
+ *
+ * Each recording is replayed by its own worker as if it were a source,
+ * named after the URI stored in the recording. The replay speed is
+ * a factor of the recorded pace, at maximum speed the throughput is
+ * shown once a recording has been replayed. The replay time is measured
+ * from here until the last sample has been applied and rendered.
+ *
+ * \param paths: First segment of each recording
+ * \param speed: Speed factor, 0 for maximum speed
+ */
+void MonitorWindow::openReplay(const QStringList &paths, double speed) {
+    closeSources();
+    uris.clear();
+    for (const QString &path : paths) uris << Replayer::readUri(path);
+    replaying = true;
+    subscription.clear();
+    replayClock.start();
+
+    for (int i = 0; i < paths.size(); i++) {
+        addSource(uris[i], paths.size() > 1 ? sourcePrefix(uris[i]) : "", 0);
+        QObject::connect(sources.last().worker,
+                         SIGNAL(replayFinished(quint64)),
+                         this, SLOT(replayFinished(quint64)));
+        QMetaObject::invokeMethod(sources.last().worker, "replay",
+                        Qt::QueuedConnection, Q_ARG(QString, paths[i]),
+                        Q_ARG(double, speed));
+    }
+    sendSubscription();
+}
+
+/*!
+ * \brief Starts the worker thread of a source
+ *
+ * \param sourceUri: WebSocket URI
+ * \param prefix: Prepended to the names of its parameters
+ * \param recorder: Records the source, 0 to not record
+ */
+void MonitorWindow::addSource(const QUrl &sourceUri, const QString &prefix,
+                              Recorder *recorder) {
+    IngestionSource source;
+    source.uri = sourceUri;
+    source.prefix = prefix;
+    source.isConnected = false;
+    source.recorder = recorder;
+    source.thread = new QThread(this);
+    source.queue = new SampleQueue<Sample>();
+    source.worker = new IngestionWorker(source.queue, source.prefix);
+    source.worker->setRecorder(recorder);
+    source.worker->moveToThread(source.thread);
+    QObject::connect(source.thread, SIGNAL(started()), source.worker,
+                                                SLOT(start()));
+    QObject::connect(source.thread, SIGNAL(finished()), source.worker,
+                                                SLOT(deleteLater()));
+    QObject::connect(source.worker, SIGNAL(connected()), this,
+                                                SLOT(connected()));
+    QObject::connect(source.worker, SIGNAL(disconnected()), this,
+                                                SLOT(disconnected()));
+    QObject::connect(source.worker, SIGNAL(samplesReady()), this,
+                                                SLOT(samplesReady()));
+    QObject::connect(source.worker, SIGNAL(catalogReceived(QStringList)),
+                     this, SLOT(catalogReceived(QStringList)));
+    sources.append(source);
+
+    source.thread->start();
+}
+
+/*!
+ * \brief Closes all connections and stops their threads
+ *
+ * Samples still queued are discarded
+ */
+void MonitorWindow::closeSources() {
+    for (const IngestionSource &source : sources) {
+        QMetaObject::invokeMethod(source.worker, "closeConnection",
+                                  Qt::BlockingQueuedConnection);
+        source.thread->quit();
+        source.thread->wait();
+        delete source.thread;
+        delete source.queue;
+        if (source.recorder) {
+            QMetaObject::invokeMethod(source.recorder, "close",
+                                      Qt::BlockingQueuedConnection);
+            source.recorder->deleteLater();
+        }
+    }
+    sources.clear();
+    ui->actionDisconnect->setEnabled(false);
+}
+
+/*!
+ * \brief Returns the index of the source of a worker
+ *
+ * \param object: Ingestion worker
+ * \return Source index, -1 if the worker was closed
+ */
+int MonitorWindow::sourceOf(QObject *object) const {
+    for (int i = 0; i < sources.size(); i++) {
+        if (sources[i].worker == object) return i;
+    }
+    return -1;
+}
+
+/*!
+ * \brief Returns the number of connected sources
+ */
+int MonitorWindow::connectedCount() const {
+    int count = 0;
+    for (const IngestionSource &source : sources) {
+        if (source.isConnected) count++;
+    }
+    return count;
+}
+
+/*!
+ * \brief Returns the connection state shown in the status bar
+ *
+ * \return URI of a single source, connected count of several sources,
+ * empty without sources
+ */
+QString MonitorWindow::sourceText() const {
+    if (sources.isEmpty()) return "";
+    if (sources.size() == 1) return sources.first().uri.toString();
+    return SOURCES_TEXT.arg(connectedCount()).arg(sources.size());
+}
+
+/*!
+ * \brief Returns the prefix qualifying the parameter names of a source
+ *
+ * \param sourceUri: WebSocket URI of the source
+ * \return Host, port and path of the URI followed by \b SOURCE_DELIMITER
+ */
+QString MonitorWindow::sourcePrefix(const QUrl &sourceUri) {
+    QString prefix = sourceUri.host();
+    if (sourceUri.port() >= 0) {
+        prefix += ":" + QString::number(sourceUri.port());
+    }
+    QString path = sourceUri.path();
+    while (path.endsWith('/')) path.chop(1);
+    return prefix + path + SOURCE_DELIMITER;
+}
+
 /*!
  * \brief Called when exiting the program via menu
  */
@@ -63,28 +423,48 @@ void MonitorWindow::on_actionExit_triggered() {
 
 /*!
  * \brief Called when connecting via menu
+ *
+ * Asks for the source URIs, one per line. Empty lines, duplicates and
+ * WSS URIs are skipped. Without a valid URI the current sources
+ * are reconnected.
  */
 void MonitorWindow::on_actionConnect_triggered() {
-    if (socket.state() == QAbstractSocket::ConnectedState
+    if (connectedCount()
             && QMessageBox::question(this, APP_NAME, DISCONNECT_CONFIRM_TEXT)
             == QMessageBox::No) return;
 
+    QStringList lines;
+    for (const QUrl &sourceUri : uris) lines << sourceUri.toString();
     bool validUri;
-    QUrl newUri = QUrl(QInputDialog::getText(this, CONNECT_TEXT, WS_URI_TEXT,
-    QLineEdit::Normal, uri.toString(), &validUri, Qt::WindowCloseButtonHint));
+    QString text = QInputDialog::getMultiLineText(this, CONNECT_TEXT,
+            WS_URI_TEXT, lines.join('\n'), &validUri,
+            Qt::WindowCloseButtonHint);
 
-    if (validUri && !isWss(newUri)) uri = newUri;
-    closeConnection();
-    autoConnect = true;
+    QList<QUrl> newUris;
+    if (validUri) {
+        for (const QString &line : text.split('\n')) {
+            QUrl newUri(line.trimmed());
+            if (line.trimmed() != "" && newUri.isValid() && !isWss(newUri)
+                    && !newUris.contains(newUri)) newUris << newUri;
+        }
+    }
+    statusBar()->showMessage(DISCONNECTED_TEXT);
+    openSources(newUris.isEmpty() ? uris : newUris);
 }
 
 /*!
  * \brief Called when closing the connection via menu
  */
 void MonitorWindow::on_actionDisconnect_triggered() {
-    if (socket.state() == QAbstractSocket::ConnectedState
+    if (connectedCount()
             && QMessageBox::question(this, APP_NAME, DISCONNECT_CONFIRM_TEXT)
-            == QMessageBox::Yes) closeConnection();
+            == QMessageBox::Yes) {
+        statusBar()->showMessage(DISCONNECTED_TEXT);
+        for (const IngestionSource &source : sources) {
+            QMetaObject::invokeMethod(source.worker, "closeConnection",
+                                      Qt::QueuedConnection);
+        }
+    }
 }
 
 /*!
@@ -93,133 +473,651 @@ void MonitorWindow::on_actionDisconnect_triggered() {
  * Removes the parameter list widget from the window
  */
 void MonitorWindow::on_actionClear_parameters_triggered() {
-    if (parameterSet.size() && QMessageBox::question(this, APP_NAME,
+    if (registry.count() && QMessageBox::question(this, APP_NAME,
         CLEAR_CONFIRM_TEXT) == QMessageBox::Yes) {
-        parameterSet.clear();
-        parameterList->clear();
-        parameterLayout->removeWidget(parameterList);
-        parameterList->hide();
+        registry.clear();
+        markSnapshotDirty();
+        history.clear();
+        latencies.clear();
+        aggregates.clear();
+        alarms.clear();
+        selectedId = -1;
+        displayedId = -1;
+        checkStale();
+        updateChart(-1);
+        rebuildDashboard();
+        sendSubscription();
+        parameterModel->clear();
+        parameterLayout->removeWidget(parameterPanel);
+        parameterPanel->hide();
         ui->actionClear_parameters->setEnabled(false);
+        addAlarmParameters();
+    }
+}
+
+/*!
+ * \brief Called when the trend chart is toggled via menu
+ *
+ * \param checked: Determines, whether the trend chart is shown
+ */
+void MonitorWindow::on_actionTrend_chart_triggered(bool checked) {
+    settings.setValue(TREND_SETTING, checked);
+    scheduleFrame();
+}
+
+/*!
+ * \brief Called when grid mode is toggled via menu
+ *
+ * In grid mode several parameters are shown at once in tiles
+ * instead of the selected parameter
+ *
+ * \param checked: Determines, whether grid mode is enabled
+ */
+void MonitorWindow::on_actionGrid_mode_triggered(bool checked) {
+    settings.setValue(GRID_SETTING, checked);
+    markSnapshotDirty();
+    text->setVisible(!checked);
+    dashboard->setVisible(checked);
+    updateAggregates();
+    if (checked) rebuildDashboard();
+    checkStale();
+    sendSubscription();
+    scheduleFrame();
+}
+
+/*!
+ * \brief Called when the performance overlay is toggled via menu
+ *
+ * Statistics are collected while the overlay is shown or a stats file
+ * is set in QSettings \b STATS_FILE_SETTING
+ *
+ * \param checked: Determines, whether the overlay is shown
+ */
+void MonitorWindow::on_actionPerformance_overlay_triggered(bool checked) {
+    settings.setValue(OVERLAY_SETTING, checked);
+    overlay->setVisible(checked);
+    if (checked) overlay->raise();
+
+    if (checked || statsFile != "") {
+        if (!statsTimer.isActive()) {
+            statsClock.start();
+            statsTimer.start(STATS_INTERVAL);
+        }
+    }
+    else statsTimer.stop();
+}
+
+/*!
+ * \brief Takes a statistics snapshot, shows it in the overlay and
+ * appends it to the stats file
+ */
+void MonitorWindow::updateStats() {
+    frameStats.merged = mergedUpdates;
+    QVector<IngestionStats*> ingestion;
+    quint64 queued = 0, dropped = 0;
+    for (const IngestionSource &source : sources) {
+        ingestion.append(&source.worker->stats());
+        queued += source.queue->size();
+        dropped += source.worker->droppedCount();
+    }
+    performance.update(ingestion, frameStats, queued, dropped, registry,
+                       statsClock.restart());
+
+    if (!overlay->isHidden()) {
+        QString overlayText = performance.overlayText();
+        if (displayedId >= 0 && displayedId < latencies.size()
+                && latencies[displayedId].count()) {
+            const LatencyHistogram &latency = latencies[displayedId];
+            overlayText += LATENCY_TEXT
+                    .arg(latency.percentile(0.5) / 1000.0, 0, 'f', 1)
+                    .arg(latency.percentile(0.99) / 1000.0, 0, 'f', 1)
+                    .arg(latency.maximum() / 1000.0, 0, 'f', 1);
+        }
+        overlay->setText(overlayText);
+        overlay->adjustSize();
+        overlay->move(centralWidget()->pos());
     }
+    if (statsFile != "") performance.write(statsFile);
+}
+
+/*!
+ * \brief Flags values that were not updated within the stale threshold
+ *
+ * The displayed value is drawn in \b STALE_COLOR and its receive time is
+ * shown in the status bar, tiles in grid mode are flagged individually.
+ * The threshold is set in QSettings \b STALE_THRESHOLD_SETTING. Values
+ * restored from a snapshot are stale until they are received again.
+ *
+ * Rather than polling, a single-shot timer is armed for the time the next
+ * visible value becomes stale. Values that are already stale need no
+ * timer, they are cleared when a new value arrives.
+ */
+void MonitorWindow::checkStale() {
+    qint64 now = QDateTime::currentMSecsSinceEpoch() * 1000;
+    qint64 next = 0;
+    if (!dashboard->isHidden()) {
+        next = dashboard->updateStale(registry, now, staleThreshold);
+    }
+
+    qint64 received = 0;
+    bool restored = false;
+    if (displayedId >= 0 && registry.contains(displayedId)) {
+        received = registry.slot(displayedId).received;
+        restored = registry.slot(displayedId).flags & PARAM_RESTORED;
+    }
+    bool stale = received && (restored || (staleThreshold > 0
+                                           && now - received > staleThreshold));
+
+    if (stale) {
+        staleLabel->setText(STALE_TEXT.arg(QDateTime::fromMSecsSinceEpoch(
+                                received / 1000).toString(STALE_TIME_FORMAT)));
+    }
+    else if (staleThreshold > 0 && received
+             && (!next || received + staleThreshold < next)) {
+        next = received + staleThreshold;
+    }
+    if (stale != isStale) {
+        isStale = stale;
+        staleLabel->setVisible(stale);
+    }
+    updateValueStyle();
+
+    if (next) staleTimer.start(int((next - now) / 1000 + 1));
+    else staleTimer.stop();
+}
+
+/*!
+ * \brief Evaluates the alarm rules depending on time only, such as
+ * missing values
+ */
+void MonitorWindow::checkAlarms() {
+    alarms.tick(QDateTime::currentMSecsSinceEpoch() * 1000);
+    if (!alarms.changedIds().isEmpty()) updateAlarms();
 }
 
 /*!
- * \brief Called when the client is connected
+ * \brief Toggles the color of a value with a raised alarm
+ */
+void MonitorWindow::flashAlarm() {
+    flashOn = !flashOn;
+    updateValueStyle();
+}
+
+/*!
+ * \brief Shows the alarm states that changed on the tiles and the value
+ */
+void MonitorWindow::updateAlarms() {
+    bool displayed = false;
+    for (int id : alarms.changedIds()) {
+        dashboard->setAlarm(id, alarms.isActive(id));
+        if (id == displayedId) displayed = true;
+    }
+    alarms.clearChanged();
+    if (displayed) updateValueStyle();
+}
+
+/*!
+ * \brief Colors the displayed value by its state
+ *
+ * A value with a raised alarm flashes in \b ALARM_COLOR and the alarms
+ * are listed in the status bar. Otherwise a stale value is drawn
+ * in \b STALE_COLOR. The palette, and with it the glyph atlas of the
+ * value widget, is changed only when the color differs.
+ */
+void MonitorWindow::updateValueStyle() {
+    bool alarm = alarms.isActive(displayedId);
+    if (alarm != flashTimer.isActive()) {
+        flashOn = true;
+        if (alarm) flashTimer.start(ALARM_FLASH_INTERVAL);
+        else flashTimer.stop();
+    }
+    if (alarm) alarmLabel->setText(ALARM_TEXT
+                                   + alarms.activeText(displayedId));
+    if (alarm == alarmLabel->isHidden()) alarmLabel->setVisible(alarm);
+
+    QColor color = QApplication::palette(text).color(QPalette::WindowText);
+    if (alarm && flashOn) color = ALARM_COLOR;
+    else if (!alarm && isStale) color = STALE_COLOR;
+    if (text->palette().color(QPalette::WindowText) == color) return;
+
+    QPalette palette = text->palette();
+    palette.setColor(QPalette::WindowText, color);
+    text->setPalette(palette);
+}
+
+/*!
+ * \brief Recreates the tiles and flags those with a raised alarm
+ */
+void MonitorWindow::rebuildDashboard() {
+    dashboard->rebuild(registry);
+    for (int id : dashboard->parameterIds()) {
+        dashboard->setAlarm(id, alarms.isActive(id));
+    }
+}
+
+/*!
+ * \brief Shows the aggregates of the displayed parameter over each
+ * window in \b ROLLING_WINDOW_LENGTHS under the value
+ *
+ * Hidden in grid mode and for parameters without numeric values.
+ * The windows move without new values, so the line is refreshed every
+ * \b AGGREGATE_INTERVAL while it is shown, and not at all otherwise.
+ */
+void MonitorWindow::updateAggregates() {
+    bool show = dashboard->isHidden() && displayedId >= 0
+                && displayedId < aggregates.size()
+                && !aggregates[displayedId].isEmpty();
+    if (show) {
+        qint64 now = receiveClock.elapsed();
+        QStringList windows;
+        for (int i = 0; i < ROLLING_WINDOWS; i++) {
+            Aggregate aggregate = aggregates[displayedId].window(i, now);
+            if (!aggregate.count) continue;
+            windows << AGGREGATE_FORMAT.arg(AGGREGATE_NAMES[i])
+                       .arg(aggregate.minimum).arg(aggregate.maximum)
+                       .arg(aggregate.mean)
+                       .arg(aggregate.standardDeviation());
+        }
+        aggregateLabel->setText(windows.join(AGGREGATE_DELIMITER));
+    }
+    if (show == aggregateLabel->isHidden()) {
+        aggregateLabel->setVisible(show);
+        resizeText();
+    }
+    if (!show) aggregateTimer.stop();
+    else if (!aggregateTimer.isActive()) {
+        aggregateTimer.start(AGGREGATE_INTERVAL);
+    }
+}
+
+/*!
+ * \brief Leaves grid mode and selects the parameter of the clicked tile
+ *
+ * \param id: Parameter ID
+ */
+void MonitorWindow::tileClicked(int id) {
+    if (!registry.contains(id)) return;
+    ui->actionGrid_mode->setChecked(false);
+    on_actionGrid_mode_triggered(false);
+    parameterSelected(registry.slot(id).name);
+}
+
+/*!
+ * \brief Called when a source is connected
+ *
+ * Stores the list of sources in QSettings \b URIS_SETTING
  */
 void MonitorWindow::connected() {
-    socket.sendTextMessage(APP_NAME + CONNECTED_TO_TEXT + uri.toString());
-    settings.setValue(URI_SETTING, uri);
+    int source = sourceOf(sender());
+    if (source < 0) return;
+    sources[source].isConnected = true;
+
+    if (!replaying) {
+        QStringList stored;
+        for (const QUrl &sourceUri : uris) stored << sourceUri.toString();
+        settings.setValue(URIS_SETTING, stored);
+    }
     ui->actionDisconnect->setEnabled(true);
-    statusBar()->showMessage(uri.toString());
+    statusBar()->showMessage(sourceText());
+}
+
+/*!
+ * \brief Called when a replayed recording has ended
+ *
+ * Applies the samples still queued and renders them, then shows the
+ * replay throughput in the status bar and logs it, so that replays
+ * at maximum speed serve as a repeatable benchmark of the whole client
+ *
+ * \param count: Number of replayed messages
+ */
+void MonitorWindow::replayFinished(quint64 count) {
+    int source = sourceOf(sender());
+    if (source < 0) return;
+    sources[source].isConnected = false;
+    SampleQueue<Sample> *queue = sources[source].queue;
+    Sample sample;
+    while (queue->pop(sample)) applySample(sample, source);
+    renderFrame();
+
+    double seconds = replayClock.nsecsElapsed() / 1e9;
+    QString message = REPLAY_FINISHED_TEXT.arg(count)
+            .arg(seconds, 0, 'f', 3)
+            .arg(seconds > 0 ? count / seconds : 0, 0, 'f', 0)
+            .arg(sources[source].worker->droppedCount());
+    statusBar()->showMessage(message);
+    qInfo().noquote() << message;
 }
 
 /*!
- * \brief Called when the client is disconnected
+ * \brief Called when a source is disconnected
  */
 void MonitorWindow::disconnected() {
-    socket.sendTextMessage(APP_NAME + DISCONNECTED_MESSAGE);
-    statusBar()->showMessage(DISCONNECTED_TEXT);
-    ui->actionDisconnect->setEnabled(false);
+    int source = sourceOf(sender());
+    if (source < 0) return;
+    sources[source].isConnected = false;
+
+    if (connectedCount()) statusBar()->showMessage(sourceText());
+    else {
+        statusBar()->showMessage(DISCONNECTED_TEXT);
+        ui->actionDisconnect->setEnabled(false);
+    }
+}
+
+/*!
+ * \brief Drains the samples decoded by an ingestion worker
+ *
+ * Called on the GUI thread when a worker has published new samples.
+ * Only the queue of that worker is drained. A replay paused by a full
+ * queue is resumed once the queue has been drained.
+ */
+void MonitorWindow::samplesReady() {
+    int source = sourceOf(sender());
+    if (source < 0) return;
+    SampleQueue<Sample> *queue = sources[source].queue;
+    queue->acknowledge();
+    Sample sample;
+    while (queue->pop(sample)) applySample(sample, source);
+    if (replaying) {
+        QMetaObject::invokeMethod(sources[source].worker, "resumeReplay",
+                                  Qt::QueuedConnection);
+    }
 }
 
 /*!
- * \brief Handles JSON parsing and parameter list management
+ * \brief Handles parameter list management
  *
  * New parameters are added to the parameter list and the sent value
- * is displayed if the message parameter type matches the one selected
+ * is scheduled for display if the sample parameter type matches
+ * the one selected. Latency probes are echoed on the next frame.
  *
- * \param message: Received message
+ * \param sample: Decoded sample
+ * \param source: Index of the source, -1 if not known
  */
-void MonitorWindow::messageReceived(QString message) {
-    QJsonDocument jsonMessage = QJsonDocument::fromJson(message.toUtf8());
-    QJsonObject jsonObject = jsonMessage.object();
-    QString name = jsonObject[JSON_NAME].toString();
-    message = jsonObject[JSON_VALUE].toString();
+void MonitorWindow::applySample(const Sample &sample, int source) {
+    const QString &name = sample.name;
+    int id = -1;
+
+    if (name == PROBE_NAME) {
+        if (sample.hasNumber && source >= 0 && source < sources.size()) {
+            sources[source].probes.append(qint64(sample.number));
+        }
+        scheduleFrame();
+        return;
+    }
 
     if (name != "") {
-        if (!(parameterSet.contains(name))) {
-            parameterSet.insert(name);
-            parameterList->addItem(name);
+        bool added;
+        id = registry.intern(name, &added);
 
-            if (parameterSet.size() == PARAM_THRESHOLD) {
-                parameterLayout->addWidget(parameterList);
-                ui->actionClear_parameters->setEnabled(true);
+        if (added) addParameter(id, name);
+        registry.update(id, sample);
+        markSnapshotDirty();
+        if (sample.timestamp && sample.received) {
+            if (id >= latencies.size()) latencies.resize(registry.capacity());
+            latencies[id].record(sample.received - sample.timestamp);
+        }
+        if (alarms.evaluate(id, sample, sample.received)) scheduleFrame();
+        bool onTile = dashboard->markChanged(id) && !dashboard->isHidden();
+        if (onTile) scheduleFrame();
+        if (staleThreshold > 0 && !staleTimer.isActive()
+                && (onTile || id == displayedId)) checkStale();
+
+        if (sample.hasNumber) {
+            qint64 now = receiveClock.elapsed();
+            history.append(id, now, sample.number);
+            if (id >= aggregates.size()) {
+                aggregates.resize(registry.capacity());
             }
+            aggregates[id].add(now, sample.number);
+            if (id == displayedId && !aggregateTimer.isActive()
+                    && dashboard->isHidden()) updateAggregates();
+            if (id == chartId) chart->append(now, sample.number);
+        }
+    }
+    else if (registry.count()) return;
 
-            if (parameterSet.size() >= PARAM_THRESHOLD) parameterList->show();
+    if (selectedId == id || registry.count() < PARAM_THRESHOLD) {
+        statusChanged = true;
+        statusName = name;
+        statusTime = sample.time;
+        statusTimestamp = sample.timestamp;
+        pendingValue = sample;
+        if (id != displayedId) {
+            displayedId = id;
+            checkStale();
+            updateAggregates();
         }
-        lastValues[name] = jsonObject[JSON_VALUE].toString();
-        lastTimes[name] = jsonObject[JSON_TIME].toString();
+        else if (isStale) checkStale();
+        if (id != chartId) updateChart(id);
+        scheduleFrame();
     }
-    else if (parameterSet.size()) return;
+}
 
-    QString statusMessage = uri.toString();
-    if (name != "") {
-        statusMessage += STATUS_DELIMITER + name;
+/*!
+ * \brief Lists a new parameter
+ *
+ * Shows the parameter list once enough parameters are known
+ *
+ * \param id: Parameter ID
+ * \param name: Parameter name
+ */
+void MonitorWindow::addParameter(int id, const QString &name) {
+    alarms.bind(id, name, QDateTime::currentMSecsSinceEpoch() * 1000);
+    parameterModel->add(id);
+    dashboard->addParameter(id, name);
+    if (!dashboard->isHidden()) sendSubscription();
+    scheduleFrame();
+
+    if (registry.count() == PARAM_THRESHOLD) {
+        parameterLayout->addWidget(parameterPanel);
+        ui->actionClear_parameters->setEnabled(true);
+    }
+
+    if (registry.count() >= PARAM_THRESHOLD) parameterPanel->show();
+}
+
+/*!
+ * \brief Lists the parameters with alarm rules
+ *
+ * Parameters are bound before their first value, so that missing rules
+ * also raise alarms for names that never arrive. They are listed
+ * without a value, like the parameters of a catalog.
+ */
+void MonitorWindow::addAlarmParameters() {
+    for (const QString &name : alarms.parameters()) {
+        bool added;
+        int id = registry.intern(name, &added);
+        if (added) addParameter(id, name);
     }
+}
 
-    if (jsonObject[JSON_TIME].toString() != "") {
-        statusMessage += STATUS_DELIMITER + jsonObject[JSON_TIME].toString();
+/*!
+ * \brief Lists the parameters of a catalog sent by the server
+ *
+ * Parameters not subscribed to are listed without a value,
+ * so that they can be selected
+ *
+ * \param names: Parameter names known by the server
+ */
+void MonitorWindow::catalogReceived(QStringList names) {
+    for (const QString &name : names) {
+        if (name == "") continue;
+        bool added;
+        int id = registry.intern(name, &added);
+        if (added) addParameter(id, name);
     }
+}
 
-    if (selectedParameter == name || parameterSet.count() < PARAM_THRESHOLD) {
-        statusBar()->showMessage(statusMessage);
-        text->setText(message);
+/*!
+ * \brief Asks the server to send only the displayed parameters
+ *
+ * In grid mode the parameters with a tile are subscribed to, otherwise
+ * the selected parameter, as well as the parameters with alarm rules.
+ * Without a selection all parameters are received. Each source is sent
+ * the names carrying its prefix, a source without displayed parameters
+ * receives all of them. Subscriptions are sent only when they change.
+ *
+ * By default all parameters are received anyway, so that the aggregates
+ * of every parameter stay complete. Subscriptions are only narrowed if
+ * QSettings \b AGGREGATE_ALL_SETTING is disabled, the aggregates of the
+ * other parameters then cover only the time they were displayed.
+ */
+void MonitorWindow::sendSubscription() {
+    QStringList names;
+    if (!aggregateAll && !dashboard->isHidden()) {
+        for (int id : dashboard->parameterIds()) {
+            names << registry.slot(id).name;
+        }
+    }
+    else if (!aggregateAll && selectedId >= 0) {
+        names << registry.slot(selectedId).name;
+    }
+    if (!names.isEmpty()) {
+        for (const QString &name : alarms.parameters()) {
+            if (!names.contains(name)) names << name;
+        }
+    }
+
+    if (names == subscription) return;
+    subscription = names;
+    for (IngestionSource &source : sources) {
+        QStringList sourceNames;
+        for (const QString &name : names) {
+            if (name.startsWith(source.prefix)) {
+                sourceNames << name.mid(source.prefix.size());
+            }
+        }
+        if (sourceNames == source.subscription) continue;
+        source.subscription = sourceNames;
+        QMetaObject::invokeMethod(source.worker, "subscribe",
+                Qt::QueuedConnection, Q_ARG(QStringList, sourceNames));
     }
-    resizeText();
 }
 
 /*!
- * \brief Closes the current WebSocket connection
+ * \brief Requests the pending value to be displayed on the next frame
+ *
+ * Updates arriving before the next frame replace the pending value
+ * and are counted as merged. Frames are rendered at most once per
+ * screen refresh or per interval set in QSettings \b FRAME_INTERVAL_SETTING
  */
-void MonitorWindow::closeConnection() {
-    if (socket.state() == QAbstractSocket::ConnectedState) {
-        socket.sendTextMessage(APP_NAME + DISCONNECTED_MESSAGE);
-        socket.close();
+void MonitorWindow::scheduleFrame() {
+    if (frameDirty) {
+        mergedUpdates++;
+        return;
     }
-    statusBar()->showMessage(DISCONNECTED_TEXT);
-    autoConnect = false;
+    frameDirty = true;
+    qint64 elapsed = frameClock.elapsed();
+    frameTimer.start(elapsed >= frameInterval ? 0 : frameInterval - elapsed);
 }
 
 /*!
- * \brief Scales the displayed text to fit the current window size
+ * \brief Changes the parameter plotted in the trend chart
+ *
+ * \param id: Parameter ID, -1 to clear the chart
  */
-void MonitorWindow::resizeText() {
-    double widthFactor =
-            QFontMetrics(text->font()).width(processText(text->text()))
-            / (double(rect().width()) - PARAM_LIST_WIDTH - PARAM_LIST_OFFSET);
+void MonitorWindow::updateChart(int id) {
+    chartId = id;
+    chart->setSource(&history, id);
+}
 
-    double heightFactor = QFontMetrics(text->font()).height()
-                                    / (double(rect().height()) - HEIGHT_OFFSET);
+/*!
+ * \brief Displays the latest pending value, status message and font size
+ *
+ * Latency probes received since the previous frame are echoed
+ * to their source with the time of this frame
+ */
+void MonitorWindow::renderFrame() {
+    if (!frameDirty) return;
+    frameDirty = false;
+    QElapsedTimer timer;
+    timer.start();
+    parameterModel->flush();
+    if (!alarms.changedIds().isEmpty()) updateAlarms();
+    if (statusChanged) {
+        QString statusMessage = sourceText();
+        if (statusName != "") statusMessage += STATUS_DELIMITER + statusName;
+        QString time = timeText(statusTime, statusTimestamp);
+        if (time != "") statusMessage += STATUS_DELIMITER + time;
+        statusBar()->showMessage(statusMessage);
+        statusChanged = false;
+    }
+    if (!dashboard->isHidden()) dashboard->refresh(registry);
+    text->setText(pendingValue.text());
+    bool showChart = ui->actionTrend_chart->isChecked() && chart->hasData()
+                     && dashboard->isHidden();
+    if (showChart == chart->isHidden()) chart->setVisible(showChart);
+    resizeText();
+    mergedLabel->setText(MERGED_TEXT + QString::number(mergedUpdates));
+    frameClock.restart();
+    frameStats.addFrame(quint64(timer.nsecsElapsed()));
 
-    double pointSize_old = font.pointSize();
-    double pointSize_new = pointSize_old;
+    for (IngestionSource &source : sources) {
+        if (source.probes.isEmpty()) continue;
+        QString echo = Subscription::encodeEcho(source.probes,
+                            QDateTime::currentMSecsSinceEpoch() * 1000);
+        QMetaObject::invokeMethod(source.worker, "send", Qt::QueuedConnection,
+                                  Q_ARG(QString, echo));
+        source.probes.clear();
+    }
+}
 
-    pointSize_new /= widthFactor > heightFactor ?
-            widthFactor / SIZE_PERCENTAGE : heightFactor / SIZE_PERCENTAGE;
+/*!
+ * \brief Scales the displayed text to fit the current window size
+ *
+ * The font, and with it the glyph atlas of the value widget, is changed
+ * only when the fitted size differs. Text of an already fitted shape
+ * and window size is not measured again
+ */
+void MonitorWindow::resizeText() {
+    QSize available(rect().width() - PARAM_LIST_WIDTH - PARAM_LIST_OFFSET,
+                    rect().height() - HEIGHT_OFFSET
+                    - (chart->isHidden() ? 0 : chart->maximumHeight())
+                    - (aggregateLabel->isHidden() ? 0
+                       : aggregateLabel->sizeHint().height()));
 
-    if (pointSize_new > 0 && !isSimilarSize(pointSize_old, pointSize_new)) {
-        font.setPointSize(pointSize_new);
+    int pointSize = fitter.fit(font, text->text(), available);
+    if (pointSize > 0 && pointSize != font.pointSize()) {
+        font.setPointSize(pointSize);
+        text->setFont(font);
     }
-    text->setFont(font);
-    windowSize = rect().size();
 }
 
 /*!
- * \brief Creates the parameter list widget
+ * \brief Creates the parameter list and its filter
+ *
+ * The list is a view over the parameter registry. Items have uniform
+ * sizes so that only the visible rows are laid out.
  */
 void MonitorWindow::createParameterList() {
-    parameterList = new QListWidget;
-    parameterList->setFixedWidth(PARAM_LIST_WIDTH);
+    parameterPanel = new QWidget;
+    parameterPanel->setFixedWidth(PARAM_LIST_WIDTH);
+    parameterPanel->hide();
+    QBoxLayout *panelLayout = new QBoxLayout(QBoxLayout::TopToBottom,
+                                             parameterPanel);
+    panelLayout->setContentsMargins(0, 0, 0, 0);
+
+    parameterFilter = new QLineEdit;
+    parameterFilter->setPlaceholderText(FILTER_TEXT);
+    parameterFilter->setClearButtonEnabled(true);
+    panelLayout->addWidget(parameterFilter);
+
+    parameterModel = new ParameterModel(&registry, this);
+    parameterList = new QListView;
+    parameterList->setModel(parameterModel);
+    parameterList->setUniformItemSizes(true);
+    parameterList->setEditTriggers(QAbstractItemView::NoEditTriggers);
     parameterList->setStyleSheet(PARAM_LIST_STYLE);
+    panelLayout->addWidget(parameterList);
+
+    QObject::connect(parameterFilter, SIGNAL(textChanged(QString)), this,
+                     SLOT(filterChanged(QString)));
 
-    QObject::connect(parameterList,
-                     SIGNAL(itemPressed(QListWidgetItem*)), this,
-                     SLOT(parameterClicked(QListWidgetItem*)));
+    QObject::connect(parameterList, SIGNAL(pressed(QModelIndex)), this,
+                     SLOT(parameterClicked(QModelIndex)));
 
-    QObject::connect(parameterList,
-                     SIGNAL(itemActivated(QListWidgetItem*)), this,
-                     SLOT(parameterClicked(QListWidgetItem*)));
+    QObject::connect(parameterList, SIGNAL(activated(QModelIndex)), this,
+                     SLOT(parameterClicked(QModelIndex)));
 }
 
 /*!
@@ -228,31 +1126,26 @@ void MonitorWindow::createParameterList() {
  * \param parameter: Selected parameter
  */
 void MonitorWindow::parameterSelected(QString parameter) {
-    selectedParameter = parameter;
-    QString statusMessage = uri.toString();
-    statusMessage += STATUS_DELIMITER + parameter;
+    selectedId = registry.find(parameter);
+    markSnapshotDirty();
+    pendingValue = Sample();
+    statusChanged = true;
+    statusName = parameter;
+    statusTime = "";
+    statusTimestamp = 0;
 
-    if (lastTimes[parameter] != "") {
-        statusMessage += STATUS_DELIMITER + lastTimes[parameter];
+    if (selectedId >= 0) {
+        const ParameterSlot &entry = registry.slot(selectedId);
+        statusTime = entry.time;
+        statusTimestamp = entry.timestamp;
+        pendingValue.value = entry.text();
     }
-    statusBar()->showMessage(statusMessage);
-    text->setText(lastValues[parameter]);
-    resizeText();
-}
-
-/*!
- * \brief Checks if the difference between two values
- * is less than or equal to a specified tolerance value
- *
- * Tolerance value specified in const short \b SIZE_DIFF_TOLERANCE
- *
- * \param oldN - old number
- * \param newN - new number
- * \return True: Difference between two values
- *               is less than or equal to the tolerance value
- */
-bool MonitorWindow::isSimilarSize(int oldN, int newN) {
-    return (oldN > newN ? oldN - newN : newN - oldN) <= SIZE_DIFF_TOLERANCE;
+    displayedId = selectedId;
+    checkStale();
+    updateAggregates();
+    updateChart(selectedId);
+    sendSubscription();
+    scheduleFrame();
 }
 
 /*!
@@ -265,10 +1158,23 @@ bool MonitorWindow::isSimilarSize(int oldN, int newN) {
  * \return Processed text
  */
 QString MonitorWindow::processText(QString text) {
-    while (text.length() < TEXT_LENGTH_MIN) {
-        text = " " + text + " ";
-    }
-    return text;
+    return FontFitter::pad(text, TEXT_LENGTH_MIN);
+}
+
+/*!
+ * \brief Returns the timestamp to be displayed
+ *
+ * Timestamps sent as numbers are displayed in the format
+ * specified in const QString \b TIME_FORMAT
+ *
+ * \param time: Timestamp as sent by the server
+ * \param timestamp: Microseconds since epoch, 0 if not known
+ * \return Displayed timestamp
+ */
+QString MonitorWindow::timeText(const QString &time, qint64 timestamp) {
+    if (time != "" || !timestamp) return time;
+    return QDateTime::fromMSecsSinceEpoch(timestamp / 1000)
+                                                    .toString(TIME_FORMAT);
 }
 
 /*!
@@ -284,10 +1190,23 @@ bool MonitorWindow::isWss(QUrl uri) {
 /*!
  * \brief Changes the selected parameter to the one clicked
  *
- * \param parameter: Clicked parameter
+ * \param index: Clicked row
+ */
+void MonitorWindow::parameterClicked(const QModelIndex &index) {
+    int id = parameterModel->parameterId(index);
+    if (id >= 0) parameterSelected(registry.slot(id).name);
+}
+
+/*!
+ * \brief Lists only the parameters whose name contains the filter text
+ *
+ * Parameters waiting for the next frame are listed first
+ *
+ * \param text: Filter text
  */
-void MonitorWindow::parameterClicked(QListWidgetItem* parameter) {
-    parameterSelected(parameter->text());
+void MonitorWindow::filterChanged(const QString &text) {
+    parameterModel->flush();
+    parameterModel->setFilter(text);
 }
 
 /*!
@@ -296,27 +1215,37 @@ void MonitorWindow::parameterClicked(QListWidgetItem* parameter) {
  * Changes the selected parameter to the next one, if available
  */
 void MonitorWindow::parameterDeleted() {
-    if (parameterList->currentItem()) {
-        parameterSet.remove(parameterList->currentItem()->text());
-        delete parameterList->currentItem();
+    int id = parameterModel->parameterId(parameterList->currentIndex());
+    if (id >= 0) {
+        parameterModel->remove(id);
+        registry.remove(id);
+        markSnapshotDirty();
+        history.remove(id);
+        if (id < latencies.size()) latencies[id].clear();
+        if (id < aggregates.size()) aggregates[id].clear();
+        alarms.unbind(id);
+        if (id == selectedId) selectedId = -1;
+        if (id == displayedId) {
+            displayedId = -1;
+            checkStale();
+        }
+        if (id == chartId) updateChart(-1);
+        rebuildDashboard();
+        sendSubscription();
 
-        if (parameterSet.isEmpty()) {
-            parameterList->hide();
+        if (!registry.count()) {
+            parameterPanel->hide();
             ui->actionClear_parameters->setEnabled(false);
         }
-        else parameterSelected(parameterList->currentItem()->text());
+        else parameterClicked(parameterList->currentIndex());
     }
 }
 
 /*!
- * \brief Handles automatic connection and text scaling
- *
- * Called every time the timer timeouts,
- * frequency set by const short \b TICK_LENGTH
+ * \brief Handles text scaling when the window is resized
  */
-void MonitorWindow::update() {
-    if (socket.state() == QAbstractSocket::UnconnectedState
-            && !uri.isEmpty() && autoConnect) socket.open(QUrl(uri));
-
-    if (windowSize != rect().size()) resizeText();
+void MonitorWindow::resizeEvent(QResizeEvent *event) {
+    QMainWindow::resizeEvent(event);
+    chart->setFixedHeight(int(rect().height() * TREND_HEIGHT_RATIO));
+    resizeText();
 }
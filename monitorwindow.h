@@ -10,19 +10,48 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QFile>
+#include <QDir>
+#include <QStandardPaths>
 #include <QLabel>
 #include <QTimer>
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QWebSocket>
 #include <QBoxLayout>
-#include <QListWidget>
+#include <QListView>
+#include <QLineEdit>
 #include <QShortcut>
 #include <QSettings>
+#include <QElapsedTimer>
+#include <QScreen>
+#include <QThread>
+#include <QDateTime>
 #include <QDebug>
 #include "ui_monitorwindow.h"
+#include "ingestionworker.h"
+#include "statesnapshot.h"
+#include "parameterregistry.h"
+#include "parametermodel.h"
+#include "historybuffer.h"
+#include "latencyhistogram.h"
+#include "alarmengine.h"
+#include "rollingstats.h"
+#include "trendchart.h"
+#include "dashboard.h"
+#include "fontfitter.h"
+#include "valueview.h"
 
-const short TICK_LENGTH = 50; /*!< Timer timeout frequency in milliseconds */
+const short FRAME_INTERVAL = 16; /*!< Fallback time between two rendered
+                                      frames in milliseconds, used when the
+                                      screen refresh rate is not known */
+const int STALE_THRESHOLD = 5000; /*!< Default age in milliseconds after
+                                       which a value is flagged as stale */
+const int AGGREGATE_INTERVAL = 250; /*!< Time between updates of the
+                                         aggregate line in milliseconds */
+const int ALARM_CHECK_INTERVAL = 250; /*!< Time between checks of the
+                                           time based alarm rules in ms */
+const int ALARM_FLASH_INTERVAL = 500; /*!< Time between color changes
+                                           of an alarmed value in ms */
 const short HEIGHT_OFFSET = 50; /*!< Height of the title and menu bar */
 const short TEXT_LENGTH_MIN = 7; /*!< Text shorter than this value
                                       is processed before display */
@@ -31,10 +60,10 @@ const short PARAM_LIST_OFFSET = 16; /*!< Additional space between text
                                          and the parameter list */
 const short PARAM_THRESHOLD = 2; /*!< Number of parameters required for the
                                       parameter list to be shown */
-const short SIZE_DIFF_TOLERANCE = 1; /*!< Required difference between two font
-                                          point sizes for text to be resized */
 const float SIZE_PERCENTAGE = 0.9f; /*!< Text size is multiplied by this value
                                          before display to make sure it fits */
+const float TREND_HEIGHT_RATIO = 0.25f; /*!< Share of the window height
+                                             used by the trend chart */
 const float WINDOW_INIT_RATIO = 0.5f; /*!< Initial window size is screen size
                                            multiplied by this value */
 
@@ -54,20 +83,126 @@ const QString DISCONNECTED_MESSAGE = " disconnected"; /*!< Sent to server upon
 const QString CONNECTED_TO_TEXT = " connected to "; /*!< Sent to server
                                                          upon connection */
 const QString CONNECT_TEXT = "Connect"; /*!< Used in connection dialog */
-const QString WS_URI_TEXT = "WebSocket URI"; /*!< Connection dialog label */
+const QString WS_URI_TEXT = "WebSocket URIs, one per line"; /*!< Connection
+                                                              dialog label */
+const QString SOURCE_DELIMITER = "/"; /*!< Separates the source from the
+                                           name of a parameter */
+const QString SOURCES_TEXT = "%1 of %2 sources connected"; /*!< Used in status
+                                        bar when there are several sources */
 const QString STATUS_DELIMITER = " - "; /*!< Used in status bar to
                                              separate different fields */
+const QString TIME_FORMAT = "yyyy/MM/dd - hh:mm:ss"; /*!< Used in status bar
+                                    for timestamps sent as numbers */
 const QString WSS_SCHEME = "wss"; /*!< Used when checking connection scheme */
 const QString PARAM_LIST_STYLE = "font-size: 12pt;"; /*!< Parameter list
                                                           style sheet */
+const QString AGGREGATE_STYLE = "font-size: 12pt;"; /*!< Aggregate line
+                                                         style sheet */
+const QString AGGREGATE_FORMAT = "%1: min %2, max %3, mean %4, sd %5";
+/*!< Aggregates of one window in the aggregate line */
+const QString AGGREGATE_NAMES[ROLLING_WINDOWS] = {"1 s", "1 min", "15 min"};
+/*!< Window names in the aggregate line */
+const QString AGGREGATE_DELIMITER = "    "; /*!< Separates the windows
+                                                in the aggregate line */
+const QString FILTER_TEXT = "Filter"; /*!< Placeholder of the
+                                           parameter filter */
 const QString DELETE_SHORTCUT = "Delete"; /*!< Key sequence for deleting
                                                a single parameter */
 
-const QString JSON_NAME = "name"; /*!< JSON field for parameter name */
-const QString JSON_VALUE = "value"; /*!< JSON field for parameter value */
-const QString JSON_TIME = "time"; /*!< JSON field for message timestamp */
-const QString URI_SETTING = "WebSocketURI"; /*!< Used in QSettings config to
-                                                 store the last connection */
+const QString URIS_SETTING = "WebSocketURIs"; /*!< Used in QSettings config
+                                to store the last connected sources */
+const QString URI_SETTING = "WebSocketURI"; /*!< Single connection stored
+                by earlier versions, read when \b URIS_SETTING is not set */
+const QString FRAME_INTERVAL_SETTING = "FrameInterval"; /*!< Used in QSettings
+                                config to override the frame interval */
+const QString TREND_SETTING = "TrendChart"; /*!< Used in QSettings config to
+                                                 store trend chart visibility */
+const QString TREND_WINDOW_SETTING = "TrendWindow"; /*!< Used in QSettings
+                        config for the trend chart time span in ms */
+const QString HISTORY_MEMORY_SETTING = "HistoryMemory"; /*!< Used in QSettings
+                        config for the history memory budget in MiB */
+const QString GRID_SETTING = "GridMode"; /*!< Used in QSettings config to
+                                              store the grid mode state */
+const QString GRID_TILES_SETTING = "GridTiles"; /*!< Used in QSettings config
+                                    for the maximum number of tiles */
+const QString OVERLAY_SETTING = "PerformanceOverlay"; /*!< Used in QSettings
+                        config to store the overlay visibility */
+const QString STATS_FILE_SETTING = "StatsFile"; /*!< Used in QSettings config
+                        for the stats file, CSV if it ends with .csv,
+                        JSON lines otherwise, empty to disable */
+const QString OVERLAY_STYLE = "background-color: rgba(0, 0, 0, 160);"
+                              "color: white; font-family: monospace;"
+                              "padding: 4px;"; /*!< Overlay style sheet */
+const QString STALE_THRESHOLD_SETTING = "StaleThreshold"; /*!< Used in
+                        QSettings config for the stale threshold in ms,
+                        0 to disable */
+const QString STALE_TEXT = "Stale since %1"; /*!< Used in status bar to show
+                                        the receive time of a stale value */
+const QString STALE_TIME_FORMAT = "hh:mm:ss"; /*!< Receive time format
+                                                   of a stale value */
+const QString AGGREGATE_ALL_SETTING = "AggregateAllParameters"; /*!< Used in
+            QSettings config to keep receiving every parameter, so that
+            aggregates are kept for parameters not displayed, enabled
+            by default, false to subscribe to the displayed ones only */
+const QString ALARM_FILE_SETTING = "AlarmFile"; /*!< Used in QSettings config
+                        for an INI file with more alarm rules */
+const QString ALARM_TEXT = "Alarm: "; /*!< Used in status bar to show
+                                           the raised alarms */
+const QString LATENCY_TEXT = "\nLatency p50/p99/max: %1/%2/%3 ms";
+/*!< Overlay text for the latency of the displayed parameter */
+const QString SNAPSHOT_FILE_SETTING = "SnapshotFile"; /*!< Used in QSettings
+            config for the state snapshot, \b SNAPSHOT_FILE_NAME in the
+            application data directory if not set, none if empty */
+const QString RECORD_DIRECTORY_SETTING = "RecordDirectory"; /*!< Used in
+            QSettings config for the directory receiving recordings,
+            nothing is recorded if not set */
+const QString RECORD_TIME_FORMAT = "yyyyMMdd-hhmmss"; /*!< Start time in the
+                                                 names of recordings */
+const QString REPLAY_OPTION = "replay"; /*!< Command line option replaying
+                                             a recording */
+const QString REPLAY_OPTION_TEXT = "Replays the recording starting with "
+        "<segment>, repeat for several sources"; /*!< Command line help */
+const QString SPEED_OPTION = "speed"; /*!< Command line option setting
+                                           the replay speed */
+const QString SPEED_OPTION_TEXT = "Replay speed factor such as 1, 10x "
+        "or max, default 1"; /*!< Command line help */
+const QString SPEED_MAX = "max"; /*!< Speed option value for replaying
+                                      as fast as possible */
+const QString RELAY_OPTION = "relay"; /*!< Command line option relaying
+                                           the sources without a window */
+const QString RELAY_OPTION_TEXT = "Relays the sources to other screens "
+        "without showing a window"; /*!< Command line help */
+const QString PORT_OPTION = "port"; /*!< Command line option setting
+                                         the relay port */
+const QString PORT_OPTION_TEXT = "Port served by the relay, default 8081";
+/*!< Command line help */
+const QString RATE_OPTION = "rate"; /*!< Command line option setting
+                                         the relay output rate */
+const QString RATE_OPTION_TEXT = "Updates sent by the relay per second, "
+        "default 10"; /*!< Command line help */
+const QString URIS_ARGUMENT_TEXT = "WebSocket URIs of the sources, "
+        "stored ones if not given"; /*!< Command line help */
+const QString REPLAY_FINISHED_TEXT = "Replayed %1 messages in %2 s "
+        "(%3 msg/s), %4 samples dropped"; /*!< Used in status bar when
+                                               a replay has finished */
+const QString MERGED_TEXT = "Merged: "; /*!< Used in status bar to show the
+                                             number of coalesced updates */
+
+/*!
+ * \brief Connection to one WebSocket server
+ */
+struct IngestionSource {
+    QUrl uri; /*!< WebSocket URI */
+    QThread *thread; /*!< Thread running the ingestion worker */
+    IngestionWorker *worker; /*!< Owns the WebSocket connection */
+    SampleQueue<Sample> *queue; /*!< Samples decoded by the worker */
+    bool isConnected; /*!< Connection state reported by the worker */
+    QString prefix; /*!< Prepended to the names of its parameters */
+    QStringList subscription; /*!< Names last subscribed to */
+    QVector<qint64> probes; /*!< Send times of the latency probes
+                                 received since the last frame */
+    Recorder *recorder; /*!< Records the source, 0 if not recorded */
+};
 
 class Ui::MonitorWindow;
 /*!
@@ -77,49 +212,141 @@ class MonitorWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    explicit MonitorWindow(QUrl quri = QUrl(), QWidget *parent = 0);
+    explicit MonitorWindow(const QList<QUrl> &quris = QList<QUrl>(),
+                           QWidget *parent = 0);
     ~MonitorWindow();
 
-    void closeConnection();
     void resizeText();
     void createParameterList();
     void parameterSelected(QString parameter);
-    bool isSimilarSize(int oldN, int newN);
     bool isWss(QUrl uri);
     QString processText(QString text);
+    QString timeText(const QString &time, qint64 timestamp);
+    void scheduleFrame();
+    void applySample(const Sample &sample, int source = -1);
+    void openSources(const QList<QUrl> &newUris);
+    void closeSources();
+    void addSource(const QUrl &sourceUri, const QString &prefix,
+                   Recorder *recorder);
+    void openReplay(const QStringList &paths, double speed);
+    int sourceOf(QObject *object) const;
+    int connectedCount() const;
+    QString sourceText() const;
+    static QString sourcePrefix(const QUrl &sourceUri);
+    void addParameter(int id, const QString &name);
+    void addAlarmParameters();
+    void sendSubscription();
+    void updateChart(int id);
+    void updateAlarms();
+    void updateValueStyle();
+    void rebuildDashboard();
+    void restoreSnapshot();
+    void markSnapshotDirty();
+    QByteArray encodeSnapshot() const;
+
+protected:
+    void resizeEvent(QResizeEvent *event);
 
 private slots:
     void on_actionExit_triggered();
     void on_actionConnect_triggered();
     void on_actionDisconnect_triggered();
     void on_actionClear_parameters_triggered();
+    void on_actionTrend_chart_triggered(bool checked);
+    void on_actionGrid_mode_triggered(bool checked);
+    void on_actionPerformance_overlay_triggered(bool checked);
+    void tileClicked(int id);
     void connected();
     void disconnected();
-    void messageReceived(QString message);
-    void parameterClicked(QListWidgetItem* parameter);
+    void samplesReady();
+    void catalogReceived(QStringList names);
+    void parameterClicked(const QModelIndex &index);
     void parameterDeleted();
-    void update();
+    void filterChanged(const QString &text);
+    void renderFrame();
+    void updateStats();
+    void checkStale();
+    void checkAlarms();
+    void flashAlarm();
+    void updateAggregates();
+    void replayFinished(quint64 count);
+    void saveSnapshot();
 
 private:
     Ui::MonitorWindow *ui; /*!< User interface object */
-    QSize windowSize; /*!< Used for storing window size and
-                           checking if the window is resized */
-    QUrl uri; /*!< WebSocket URI */
-    QWebSocket socket; /*!< Current WebSocket object */
+    QList<QUrl> uris; /*!< WebSocket URIs */
+    QVector<IngestionSource> sources; /*!< Connection of each URI, each
+                                           with its own thread and queue */
+    bool replaying; /*!< Determines, whether the sources are replayed
+                         recordings instead of connections */
+    QElapsedTimer replayClock; /*!< Time since the replay started */
+    QThread *writerThread; /*!< Thread writing recordings and snapshots */
+    StateSnapshot *snapshot; /*!< Writes the state snapshot,
+                                  0 if disabled */
+    QTimer snapshotTimer; /*!< Triggers writing the snapshot once after
+                               the state changed */
+    bool snapshotDirty; /*!< Determines, whether the state has changed
+                             since the last snapshot */
     QBoxLayout *layout; /*!< Main layout used for displaying text */
     QBoxLayout *parameterLayout; /*!< Layout containing the
-                                      parameter list widget */
-    QListWidget *parameterList; /*!< Parameter list widget */
-    QLabel *text; /*!< Text label for displaying received values */
+                                      parameter panel */
+    QWidget *parameterPanel; /*!< Parameter filter and list */
+    QLineEdit *parameterFilter; /*!< Filters the parameter list by name */
+    QListView *parameterList; /*!< Parameter list view */
+    ParameterModel *parameterModel; /*!< Parameters listed in the view */
+    QBoxLayout *valueLayout; /*!< Layout containing the value widget
+                                  and the trend chart */
+    ValueView *text; /*!< Widget for displaying received values */
+    QLabel *aggregateLabel; /*!< Aggregates of the displayed parameter
+                                 shown under the value */
+    QVector<RollingStats> aggregates; /*!< Windowed aggregates of each
+                                           parameter ID */
+    QTimer aggregateTimer; /*!< Triggers updates of the aggregate line */
+    bool aggregateAll; /*!< Determines, whether every parameter is received
+                            for its aggregates instead of the displayed */
+    TrendChart *chart; /*!< Trend chart of the displayed parameter */
+    Dashboard *dashboard; /*!< Tiles shown in grid mode */
+    HistoryStore history; /*!< Numeric history of each parameter */
+    int chartId; /*!< Parameter ID plotted in the trend chart */
+    QElapsedTimer receiveClock; /*!< Used for timing history points */
     QString prevText; /*!< Used for storing the previous value as a string */
-    QFont font; /*!< Font object for the text label */
-    QSet<QString> parameterSet; /*!< Set of received parameters */
-    QString selectedParameter; /*!< Selected parameter name */
-    QHash<QString, QString> lastValues; /*!< Last value for each parameter */
-    QHash<QString, QString> lastTimes; /*!< Last timestamp for each parameter */
+    QFont font; /*!< Font object for the value widget */
+    FontFitter fitter; /*!< Caches font sizes fitted for the value widget */
+    ParameterRegistry registry; /*!< State of received parameters */
+    int selectedId; /*!< Selected parameter ID, -1 if none is selected */
+    int displayedId; /*!< Displayed parameter ID, -1 if none */
+    QVector<LatencyHistogram> latencies; /*!< Latency from the timestamp
+                                              to receiving, per parameter ID */
+    QStringList subscription; /*!< Names last subscribed to */
     QSettings settings; /*!< Used for storing program configuration */
-    bool autoConnect; /*!< Determines, whether the program should try
-                           connecting to a WebSocket server automatically */
+    QTimer frameTimer; /*!< Single shot timer triggering the next frame */
+    QElapsedTimer frameClock; /*!< Time since the last rendered frame */
+    int frameInterval; /*!< Minimum time between frames in milliseconds */
+    bool frameDirty; /*!< Determines, whether a frame is pending */
+    quint64 mergedUpdates; /*!< Number of updates merged into a later frame */
+    QLabel *mergedLabel; /*!< Status bar label showing merged updates */
+    QTimer staleTimer; /*!< Triggers staleness checks */
+    qint64 staleThreshold; /*!< Maximum age of a value in microseconds */
+    bool isStale; /*!< Determines, whether the displayed value is stale */
+    QLabel *staleLabel; /*!< Status bar label showing the stale age */
+    AlarmEngine alarms; /*!< Alarm rules compiled per parameter ID */
+    QTimer alarmTimer; /*!< Triggers checks of time based alarm rules */
+    QTimer flashTimer; /*!< Flashes the value while an alarm is raised */
+    bool flashOn; /*!< Determines, whether the flashing value is colored */
+    QLabel *alarmLabel; /*!< Status bar label showing the raised alarms */
+    FrameStats frameStats; /*!< Frame counters */
+    PerformanceStats performance; /*!< Rates shown in the overlay */
+    QTimer statsTimer; /*!< Triggers statistics snapshots */
+    QElapsedTimer statsClock; /*!< Time since the last snapshot */
+    QString statsFile; /*!< Stats file, empty if not written */
+    QLabel *overlay; /*!< Performance overlay */
+    Sample pendingValue; /*!< Value to be displayed on the next frame,
+                              formatted when it is drawn */
+    bool statusChanged; /*!< Determines, whether the status bar is
+                             updated on the next frame */
+    QString statusName; /*!< Parameter name shown on the next frame */
+    QString statusTime; /*!< Time field shown on the next frame */
+    qint64 statusTimestamp; /*!< Timestamp shown on the next frame */
 };
 
 #endif // MONITORWINDOW_H
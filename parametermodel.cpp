@@ -0,0 +1,143 @@
+/*!
+ * \file parametermodel.cpp
+ */
+#include "parametermodel.h"
+
+/*!
+ * \brief ParameterModel constructor
+ *
+ * \param registry: Registry holding the parameter names
+ */
+ParameterModel::ParameterModel(const ParameterRegistry *registry,
+                               QObject *parent)
+    : QAbstractListModel(parent), registry(registry) {}
+
+/*!
+ * \brief Returns the number of rows matching the filter
+ */
+int ParameterModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+/*!
+ * \brief Returns the name or the ID of the parameter on a row
+ *
+ * \param index: Row index
+ * \param role: Qt::DisplayRole or \b PARAM_ID_ROLE
+ */
+QVariant ParameterModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+    int id = rows.at(index.row());
+    if (role == Qt::DisplayRole) return registry->slot(id).name;
+    if (role == PARAM_ID_ROLE) return id;
+    return QVariant();
+}
+
+/*!
+ * \brief Queues a new parameter to be listed on the next flush
+ *
+ * \param id: Parameter ID
+ */
+void ParameterModel::add(int id) {
+    pending.append(id);
+}
+
+/*!
+ * \brief Removes a parameter from the list
+ *
+ * Must be called before the parameter is removed from the registry
+ *
+ * \param id: Parameter ID
+ */
+void ParameterModel::remove(int id) {
+    pending.removeOne(id);
+    ids.removeOne(id);
+
+    int row = rows.indexOf(id);
+    if (row < 0) return;
+    beginRemoveRows(QModelIndex(), row, row);
+    rows.remove(row);
+    endRemoveRows();
+}
+
+/*!
+ * \brief Removes all parameters from the list
+ */
+void ParameterModel::clear() {
+    beginResetModel();
+    ids.clear();
+    rows.clear();
+    pending.clear();
+    endResetModel();
+}
+
+/*!
+ * \brief Lists the parameters added since the last flush
+ *
+ * Matching parameters are inserted with a single rowsInserted signal
+ */
+void ParameterModel::flush() {
+    if (pending.isEmpty()) return;
+    ids += pending;
+
+    QVector<int> matching;
+    matching.reserve(pending.size());
+    for (int id : pending) {
+        if (matches(id)) matching.append(id);
+    }
+    pending.clear();
+    if (matching.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), rows.size(),
+                    rows.size() + matching.size() - 1);
+    rows += matching;
+    endInsertRows();
+}
+
+/*!
+ * \brief Lists only the parameters whose name contains the text
+ *
+ * When the text extends the previous filter, only the rows already
+ * matching are checked again, so that typing stays responsive
+ * with a large number of parameters
+ *
+ * \param text: Filter text, empty to list all parameters
+ */
+void ParameterModel::setFilter(const QString &text) {
+    if (text == filter) return;
+    bool narrowing = !filter.isEmpty()
+                     && text.startsWith(filter, Qt::CaseInsensitive);
+    filter = text;
+
+    const QVector<int> &candidates = narrowing ? rows : ids;
+    QVector<int> matching;
+    matching.reserve(candidates.size());
+    for (int id : candidates) {
+        if (matches(id)) matching.append(id);
+    }
+
+    beginResetModel();
+    rows.swap(matching);
+    endResetModel();
+}
+
+/*!
+ * \brief Returns the parameter ID of a row
+ *
+ * \param index: Row index
+ * \return Parameter ID, -1 if the index is not valid
+ */
+int ParameterModel::parameterId(const QModelIndex &index) const {
+    if (!index.isValid() || index.row() >= rows.size()) return -1;
+    return rows.at(index.row());
+}
+
+/*!
+ * \brief Checks if the name of a parameter matches the filter
+ *
+ * \param id: Parameter ID
+ */
+bool ParameterModel::matches(int id) const {
+    return filter.isEmpty()
+           || registry->slot(id).name.contains(filter, Qt::CaseInsensitive);
+}
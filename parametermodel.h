@@ -0,0 +1,50 @@
+/*!
+ * \file parametermodel.h
+ */
+#ifndef PARAMETERMODEL_H
+#define PARAMETERMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QString>
+#include "parameterregistry.h"
+
+const int PARAM_ID_ROLE = Qt::UserRole; /*!< Item data role for
+                                             the parameter ID */
+
+/*!
+ * \brief ParameterModel class
+ *
+ * Lists the parameters of a registry in the order they were first seen.
+ * Names are read from the registry on demand, so the model stores only
+ * IDs. Parameters added between frames are inserted as one batch by
+ * flush(). The listed rows can be narrowed down by a filter text.
+ */
+class ParameterModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit ParameterModel(const ParameterRegistry *registry,
+                            QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+
+    void add(int id);
+    void remove(int id);
+    void clear();
+    void flush();
+    void setFilter(const QString &text);
+    int parameterId(const QModelIndex &index) const;
+
+private:
+    bool matches(int id) const;
+
+    const ParameterRegistry *registry; /*!< Registry holding the names */
+    QVector<int> ids; /*!< IDs of all listed parameters */
+    QVector<int> rows; /*!< IDs of the rows matching the filter */
+    QVector<int> pending; /*!< IDs added since the last flush */
+    QString filter; /*!< Current filter text */
+};
+
+#endif // PARAMETERMODEL_H
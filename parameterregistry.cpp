@@ -0,0 +1,134 @@
+/*!
+ * \file parameterregistry.cpp
+ */
+#include "parameterregistry.h"
+
+/*!
+ * \brief ParameterRegistry constructor
+ */
+ParameterRegistry::ParameterRegistry() : sequence(0) {}
+
+/*!
+ * \brief Returns the ID of a parameter, adding it if it is not known yet
+ *
+ * \param name: Parameter name
+ * \param added: Set to true if the parameter was added
+ * \return Parameter ID
+ */
+int ParameterRegistry::intern(const QString &name, bool *added) {
+    QHash<QString, int>::iterator it = ids.find(name);
+    if (added) *added = it == ids.end();
+    if (it != ids.end()) return it.value();
+
+    int id;
+    if (freeIds.isEmpty()) {
+        id = entries.size();
+        entries.append(ParameterSlot());
+    }
+    else id = freeIds.takeLast();
+
+    ParameterSlot &entry = entries[id];
+    entry.name = name;
+    entry.number = 0;
+    entry.format = SAMPLE_TEXT;
+    entry.timestamp = 0;
+    entry.received = 0;
+    entry.sequence = 0;
+    entry.updates = 0;
+    entry.flags = PARAM_IN_USE;
+    ids.insert(name, id);
+    return id;
+}
+
+/*!
+ * \brief Returns the ID of a known parameter
+ *
+ * \param name: Parameter name
+ * \return Parameter ID or -1 if the parameter is not known
+ */
+int ParameterRegistry::find(const QString &name) const {
+    return ids.value(name, -1);
+}
+
+/*!
+ * \brief Stores the value and timestamp of a sample
+ *
+ * \param id: Parameter ID
+ * \param sample: Received sample
+ */
+void ParameterRegistry::update(int id, const Sample &sample) {
+    ParameterSlot &entry = entries[id];
+    entry.value = sample.value;
+    entry.time = sample.time;
+    entry.unit = sample.unit;
+    entry.number = sample.number;
+    entry.format = sample.format;
+    entry.timestamp = sample.timestamp;
+    entry.received = sample.received;
+    entry.sequence = ++sequence;
+    entry.updates++;
+    entry.flags = (entry.flags | PARAM_CHANGED) & ~PARAM_RESTORED;
+}
+
+/*!
+ * \brief Removes a parameter and reclaims its slot
+ *
+ * \param id: Parameter ID
+ */
+void ParameterRegistry::remove(int id) {
+    if (!contains(id)) return;
+    ids.remove(entries[id].name);
+    entries[id] = ParameterSlot();
+    freeIds.append(id);
+}
+
+/*!
+ * \brief Removes all parameters
+ */
+void ParameterRegistry::clear() {
+    ids.clear();
+    entries.clear();
+    freeIds.clear();
+}
+
+/*!
+ * \brief Returns the number of parameters
+ */
+int ParameterRegistry::count() const {
+    return ids.size();
+}
+
+/*!
+ * \brief Returns the number of slots, including reclaimed ones
+ */
+int ParameterRegistry::capacity() const {
+    return entries.size();
+}
+
+/*!
+ * \brief Checks if an ID refers to a parameter
+ *
+ * \param id: Parameter ID
+ * \return True: ID refers to a parameter
+ */
+bool ParameterRegistry::contains(int id) const {
+    return id >= 0 && id < entries.size() && entries[id].flags & PARAM_IN_USE;
+}
+
+/*!
+ * \brief Returns the slot of a parameter
+ *
+ * \param id: Parameter ID
+ */
+const ParameterSlot &ParameterRegistry::slot(int id) const {
+    return entries[id];
+}
+
+/*!
+ * \brief Returns the slot of a parameter
+ *
+ * \param id: Parameter ID
+ */
+ParameterSlot &ParameterRegistry::slot(int id) {
+    return entries[id];
+}
@@ -0,0 +1,76 @@
+/*!
+ * \file parameterregistry.h
+ */
+#ifndef PARAMETERREGISTRY_H
+#define PARAMETERREGISTRY_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include "sample.h"
+
+const quint32 PARAM_IN_USE = 0x1; /*!< Flag set for slots holding
+                                       a parameter */
+const quint32 PARAM_CHANGED = 0x2; /*!< Flag set when the value changes,
+                                        cleared by the display */
+const quint32 PARAM_RESTORED = 0x4; /*!< Flag set for values restored from
+                                         a snapshot, cleared by the first
+                                         received value */
+
+/*!
+ * \brief State stored for each parameter
+ */
+struct ParameterSlot {
+    QString name; /*!< Parameter name */
+    QString value; /*!< Last value, empty unless format is \b SAMPLE_TEXT */
+    QString time; /*!< Last timestamp as sent by the server */
+    QString unit; /*!< Unit of a formatted number */
+    double number; /*!< Last number of a formatted value */
+    quint8 format; /*!< How the value is displayed, see sample.h */
+    qint64 timestamp; /*!< Last timestamp in microseconds since epoch */
+    qint64 received; /*!< Receive time of the last value in microseconds
+                          since epoch */
+    quint64 sequence; /*!< Registry sequence number of the last update */
+    quint64 updates; /*!< Number of updates received */
+    quint32 flags; /*!< Combination of the PARAM_ flags */
+
+    /*!
+     * \brief Returns the last value as displayed
+     */
+    QString text() const {
+        if (format == SAMPLE_TEXT) return value;
+        return ValueParser::format(number, unit, format == SAMPLE_INTEGER);
+    }
+};
+
+/*!
+ * \brief ParameterRegistry class
+ *
+ * Interns parameter names into dense integer IDs and keeps the state
+ * of each parameter in a contiguous slot. IDs of removed parameters
+ * are reused by later parameters.
+ */
+class ParameterRegistry {
+
+public:
+    ParameterRegistry();
+
+    int intern(const QString &name, bool *added = 0);
+    int find(const QString &name) const;
+    void update(int id, const Sample &sample);
+    void remove(int id);
+    void clear();
+    int count() const;
+    int capacity() const;
+    bool contains(int id) const;
+    const ParameterSlot &slot(int id) const;
+    ParameterSlot &slot(int id);
+
+private:
+    QHash<QString, int> ids; /*!< Parameter name to ID */
+    QVector<ParameterSlot> entries; /*!< Slots indexed by ID */
+    QVector<int> freeIds; /*!< IDs of removed parameters */
+    quint64 sequence; /*!< Number of updates so far */
+};
+
+#endif // PARAMETERREGISTRY_H
@@ -0,0 +1,247 @@
+/*!
+ * \file performancestats.cpp
+ */
+#include "performancestats.h"
+#include <QFile>
+#include <QDateTime>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+
+/*!
+ * \brief Counts a decoded message
+ *
+ * \param size: Message size in bytes
+ * \param count: Number of decoded samples
+ * \param nanoseconds: Decode time
+ */
+void IngestionStats::addMessage(quint64 size, quint64 count,
+                                quint64 nanoseconds) {
+    messages.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    samples.fetch_add(count, std::memory_order_relaxed);
+    decodeNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    quint64 maximum = decodeMaximum.load(std::memory_order_relaxed);
+    while (nanoseconds > maximum && !decodeMaximum.compare_exchange_weak(
+               maximum, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+/*!
+ * \brief Counts the UTF-8 bytes of a text message without converting it
+ *
+ * \param text: Received text message
+ * \return Size of the message as sent
+ */
+quint64 IngestionStats::utf8Size(const QString &text) {
+    quint64 size = 0;
+    for (QChar c : text) {
+        ushort unicode = c.unicode();
+        if (unicode < 0x80) size += 1;
+        else if (unicode < 0x800 || c.isSurrogate()) size += 2;
+        else size += 3;
+    }
+    return size;
+}
+
+/*!
+ * \brief Counts a rendered frame
+ *
+ * \param nanoseconds: Frame time
+ */
+void FrameStats::addFrame(quint64 nanoseconds) {
+    frames++;
+    frameNanoseconds += nanoseconds;
+    frameMaximum = qMax(frameMaximum, nanoseconds);
+}
+
+/*!
+ * \brief PerformanceStats constructor
+ */
+PerformanceStats::PerformanceStats() : messages(0), bytes(0), samples(0),
+    decodeNanoseconds(0), frames(0), frameNanoseconds(0), merged(0) {}
+
+/*!
+ * \brief Computes the rates since the previous snapshot
+ *
+ * \param ingestion: Counters of each ingestion worker, summed up
+ * \param frame: Counters of the GUI thread
+ * \param queued: Samples waiting for the GUI thread
+ * \param dropped: Samples dropped so far
+ * \param registry: Parameters with their update counts
+ * \param elapsed: Time since the previous snapshot in milliseconds
+ * \return New snapshot
+ */
+const StatsSnapshot &PerformanceStats::update(
+        const QVector<IngestionStats*> &ingestion, FrameStats &frame,
+        quint64 queued, quint64 dropped, const ParameterRegistry &registry,
+        qint64 elapsed) {
+    double seconds = qMax(elapsed, qint64(1)) / 1000.0;
+    quint64 nowMessages = 0, nowBytes = 0, nowSamples = 0, nowDecode = 0;
+    quint64 decodeMaximum = 0;
+    for (IngestionStats *stats : ingestion) {
+        nowMessages += stats->messages.load(std::memory_order_relaxed);
+        nowBytes += stats->bytes.load(std::memory_order_relaxed);
+        nowSamples += stats->samples.load(std::memory_order_relaxed);
+        nowDecode += stats->decodeNanoseconds.load(std::memory_order_relaxed);
+        decodeMaximum = qMax(decodeMaximum, stats->decodeMaximum
+                             .exchange(0, std::memory_order_relaxed));
+    }
+    if (nowMessages < messages) {
+        messages = bytes = samples = decodeNanoseconds = 0;
+    }
+    quint64 decoded = nowMessages - messages;
+    quint64 rendered = frame.frames - frames;
+
+    current.time = QDateTime::currentMSecsSinceEpoch();
+    current.messagesPerSecond = decoded / seconds;
+    current.bytesPerSecond = (nowBytes - bytes) / seconds;
+    current.samplesPerSecond = (nowSamples - samples) / seconds;
+    current.decodeAverage = decoded ? (nowDecode - decodeNanoseconds)
+                                      / 1000.0 / decoded : 0;
+    current.decodeMaximum = decodeMaximum / 1000.0;
+    current.framesPerSecond = rendered / seconds;
+    current.frameAverage = rendered ? (frame.frameNanoseconds
+                           - frameNanoseconds) / 1000.0 / rendered : 0;
+    current.frameMaximum = frame.frameMaximum / 1000.0;
+    current.mergedPerSecond = (frame.merged - merged) / seconds;
+    current.queued = queued;
+    current.dropped = dropped;
+
+    messages = nowMessages;
+    bytes = nowBytes;
+    samples = nowSamples;
+    decodeNanoseconds = nowDecode;
+    frames = frame.frames;
+    frameNanoseconds = frame.frameNanoseconds;
+    merged = frame.merged;
+    frame.frameMaximum = 0;
+
+    rates.clear();
+    updates.resize(registry.capacity());
+    for (int id = 0; id < registry.capacity(); id++) {
+        if (!registry.contains(id)) {
+            updates[id] = 0;
+            continue;
+        }
+        quint64 count = registry.slot(id).updates;
+        quint64 delta = count >= updates[id] ? count - updates[id] : count;
+        updates[id] = count;
+        if (delta) rates.append(qMakePair(delta / seconds, id));
+    }
+    int top = qMin(rates.size(), STATS_TOP_PARAMETERS);
+    std::partial_sort(rates.begin(), rates.begin() + top, rates.end(),
+        [](const QPair<double, int> &a, const QPair<double, int> &b) {
+            return a.first > b.first;
+        });
+    current.topParameters.clear();
+    for (int i = 0; i < top; i++) {
+        current.topParameters.append(qMakePair(
+                    registry.slot(rates[i].second).name, rates[i].first));
+    }
+    return current;
+}
+
+/*!
+ * \brief Returns the latest snapshot
+ */
+const StatsSnapshot &PerformanceStats::snapshot() const {
+    return current;
+}
+
+/*!
+ * \brief Returns the latest snapshot as text for the overlay
+ */
+QString PerformanceStats::overlayText() const {
+    QString text = OVERLAY_FORMAT
+            .arg(current.messagesPerSecond, 0, 'f', 0)
+            .arg(current.bytesPerSecond, 0, 'f', 0)
+            .arg(current.samplesPerSecond, 0, 'f', 0)
+            .arg(current.decodeAverage, 0, 'f', 1)
+            .arg(current.decodeMaximum, 0, 'f', 1)
+            .arg(current.framesPerSecond, 0, 'f', 1)
+            .arg(current.frameAverage, 0, 'f', 0)
+            .arg(current.frameMaximum, 0, 'f', 0)
+            .arg(current.mergedPerSecond, 0, 'f', 0)
+            .arg(current.queued)
+            .arg(current.dropped);
+    for (const QPair<QString, double> &parameter : current.topParameters) {
+        text += "\n" + parameter.first + ": "
+                + QString::number(parameter.second, 'f', 1) + "/s";
+    }
+    return text;
+}
+
+/*!
+ * \brief Appends the latest snapshot to a stats file
+ *
+ * Files ending with \b CSV_EXTENSION get one CSV row per snapshot,
+ * other files one JSON object per line
+ *
+ * \param path: Stats file
+ * \return True: Snapshot written
+ */
+bool PerformanceStats::write(const QString &path) const {
+    QFile file(path);
+    bool isCsv = path.endsWith(CSV_EXTENSION, Qt::CaseInsensitive);
+    bool isNew = !file.exists() || file.size() == 0;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append
+                   | QIODevice::Text)) return false;
+
+    QTextStream stream(&file);
+    if (isCsv && isNew) stream << CSV_HEADER << "\n";
+    stream << (isCsv ? csvLine() : jsonLine()) << "\n";
+    return stream.status() == QTextStream::Ok;
+}
+
+/*!
+ * \brief Returns the latest snapshot as a CSV row
+ */
+QString PerformanceStats::csvLine() const {
+    QStringList top;
+    for (const QPair<QString, double> &parameter : current.topParameters) {
+        top << QString(parameter.first).replace('"', "\"\"") + "="
+               + QString::number(parameter.second, 'f', 1);
+    }
+    return QStringList({QString::number(current.time),
+            QString::number(current.messagesPerSecond, 'f', 1),
+            QString::number(current.bytesPerSecond, 'f', 1),
+            QString::number(current.samplesPerSecond, 'f', 1),
+            QString::number(current.decodeAverage, 'f', 2),
+            QString::number(current.decodeMaximum, 'f', 2),
+            QString::number(current.framesPerSecond, 'f', 1),
+            QString::number(current.frameAverage, 'f', 1),
+            QString::number(current.frameMaximum, 'f', 1),
+            QString::number(current.mergedPerSecond, 'f', 1),
+            QString::number(current.queued),
+            QString::number(current.dropped),
+            "\"" + top.join(';') + "\""}).join(',');
+}
+
+/*!
+ * \brief Returns the latest snapshot as a single line JSON object
+ */
+QString PerformanceStats::jsonLine() const {
+    QJsonObject top;
+    for (const QPair<QString, double> &parameter : current.topParameters) {
+        top.insert(parameter.first, parameter.second);
+    }
+    QJsonObject object;
+    object.insert("time", double(current.time));
+    object.insert("messagesPerSecond", current.messagesPerSecond);
+    object.insert("bytesPerSecond", current.bytesPerSecond);
+    object.insert("samplesPerSecond", current.samplesPerSecond);
+    object.insert("decodeAverageUs", current.decodeAverage);
+    object.insert("decodeMaximumUs", current.decodeMaximum);
+    object.insert("framesPerSecond", current.framesPerSecond);
+    object.insert("frameAverageUs", current.frameAverage);
+    object.insert("frameMaximumUs", current.frameMaximum);
+    object.insert("mergedPerSecond", current.mergedPerSecond);
+    object.insert("queued", double(current.queued));
+    object.insert("dropped", double(current.dropped));
+    object.insert("topParameters", top);
+    return QString::fromUtf8(QJsonDocument(object)
+                             .toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,115 @@
+/*!
+ * \file performancestats.h
+ */
+#ifndef PERFORMANCESTATS_H
+#define PERFORMANCESTATS_H
+
+#include <QString>
+#include <QVector>
+#include <QPair>
+#include <atomic>
+#include "parameterregistry.h"
+
+const int STATS_INTERVAL = 1000; /*!< Time between statistics snapshots
+                                      in milliseconds */
+const int STATS_TOP_PARAMETERS = 5; /*!< Number of parameters listed
+                                         by update rate */
+const QString OVERLAY_FORMAT =
+        "Messages/s: %1\nBytes/s: %2\nSamples/s: %3\n"
+        "Decode: %4 us avg, %5 us max\nFrames/s: %6\n"
+        "Frame: %7 us avg, %8 us max\nMerged/s: %9\n"
+        "Queued: %10\nDropped: %11"; /*!< Overlay text */
+const QString CSV_HEADER = "time,messages_per_s,bytes_per_s,samples_per_s,"
+        "decode_avg_us,decode_max_us,frames_per_s,frame_avg_us,frame_max_us,"
+        "merged_per_s,queued,dropped,top_parameters"; /*!< CSV columns */
+const QString CSV_EXTENSION = ".csv"; /*!< Stats files with this extension
+                                           are written as CSV */
+
+/*!
+ * \brief Counters updated by the ingestion worker
+ *
+ * Relaxed atomic additions only, read by the GUI thread for snapshots
+ */
+struct IngestionStats {
+    std::atomic<quint64> messages{0}; /*!< Received messages */
+    std::atomic<quint64> bytes{0}; /*!< Received message bytes */
+    std::atomic<quint64> samples{0}; /*!< Decoded samples */
+    std::atomic<quint64> decodeNanoseconds{0}; /*!< Time spent decoding */
+    std::atomic<quint64> decodeMaximum{0}; /*!< Longest decode in ns
+                                                since the last snapshot */
+
+    void addMessage(quint64 size, quint64 count, quint64 nanoseconds);
+    static quint64 utf8Size(const QString &text);
+};
+
+/*!
+ * \brief Counters updated by the GUI thread
+ */
+struct FrameStats {
+    quint64 frames = 0; /*!< Rendered frames */
+    quint64 frameNanoseconds = 0; /*!< Time spent rendering frames */
+    quint64 frameMaximum = 0; /*!< Longest frame in ns since the last
+                                   snapshot */
+    quint64 merged = 0; /*!< Updates merged into a later frame */
+
+    void addFrame(quint64 nanoseconds);
+};
+
+/*!
+ * \brief Rates computed from two consecutive snapshots of the counters
+ */
+struct StatsSnapshot {
+    qint64 time = 0; /*!< Snapshot time in milliseconds since epoch */
+    double messagesPerSecond = 0; /*!< Received messages per second */
+    double bytesPerSecond = 0; /*!< Received bytes per second */
+    double samplesPerSecond = 0; /*!< Decoded samples per second */
+    double decodeAverage = 0; /*!< Average decode time in microseconds */
+    double decodeMaximum = 0; /*!< Longest decode time in microseconds */
+    double framesPerSecond = 0; /*!< Rendered frames per second */
+    double frameAverage = 0; /*!< Average frame time in microseconds */
+    double frameMaximum = 0; /*!< Longest frame time in microseconds */
+    double mergedPerSecond = 0; /*!< Merged updates per second */
+    quint64 queued = 0; /*!< Samples waiting for the GUI thread */
+    quint64 dropped = 0; /*!< Samples dropped due to a full queue */
+    QVector<QPair<QString, double>> topParameters; /*!< Most updated
+                                    parameters and their updates per second */
+};
+
+/*!
+ * \brief PerformanceStats class
+ *
+ * Turns the counters into rates once per snapshot and exports them.
+ * Nothing is allocated on the paths updating the counters.
+ */
+class PerformanceStats {
+
+public:
+    PerformanceStats();
+
+    const StatsSnapshot &update(const QVector<IngestionStats*> &ingestion,
+                                FrameStats &frame, quint64 queued,
+                                quint64 dropped,
+                                const ParameterRegistry &registry,
+                                qint64 elapsed);
+    const StatsSnapshot &snapshot() const;
+    QString overlayText() const;
+    bool write(const QString &path) const;
+
+private:
+    QString csvLine() const;
+    QString jsonLine() const;
+
+    StatsSnapshot current; /*!< Latest snapshot */
+    quint64 messages; /*!< Message count at the previous snapshot */
+    quint64 bytes; /*!< Byte count at the previous snapshot */
+    quint64 samples; /*!< Sample count at the previous snapshot */
+    quint64 decodeNanoseconds; /*!< Decode time at the previous snapshot */
+    quint64 frames; /*!< Frame count at the previous snapshot */
+    quint64 frameNanoseconds; /*!< Frame time at the previous snapshot */
+    quint64 merged; /*!< Merged updates at the previous snapshot */
+    QVector<quint64> updates; /*!< Update count of each parameter ID
+                                   at the previous snapshot */
+    QVector<QPair<double, int>> rates; /*!< Reused for sorting parameters */
+};
+
+#endif // PERFORMANCESTATS_H
@@ -0,0 +1,110 @@
+/*!
+ * \file recorder.cpp
+ */
+#include "recorder.h"
+#include <QtEndian>
+#include <QRegularExpression>
+#include <cstring>
+
+/*!
+ * \brief Recorder constructor
+ *
+ * The first segment is created on the first write
+ *
+ * \param base: Segment path without "-<n>.rec"
+ * \param uri: Recorded source
+ */
+Recorder::Recorder(const QString &base, const QUrl &uri, QObject *parent)
+    : QObject(parent), base(base), uri(uri), segment(-1) {}
+
+/*!
+ * \brief Encodes a frame at the end of a buffer
+ *
+ * \param buffer: Buffer of frames
+ * \param time: Receive time in microseconds since epoch
+ * \param isBinary: Determines, whether the message is a binary message
+ * \param data: Message bytes, UTF-8 for text messages
+ * \param size: Number of message bytes
+ */
+void Recorder::appendFrame(QByteArray &buffer, qint64 time, bool isBinary,
+                           const char *data, int size) {
+    int offset = buffer.size();
+    buffer.resize(offset + RECORD_FRAME_HEADER_SIZE + size);
+    uchar *header = reinterpret_cast<uchar*>(buffer.data() + offset);
+    qToLittleEndian<qint64>(time, header);
+    qToLittleEndian<quint32>(quint32(size) | (isBinary ? RECORD_BINARY : 0),
+                             header + 8);
+    memcpy(header + RECORD_FRAME_HEADER_SIZE, data, size_t(size));
+}
+
+/*!
+ * \brief Returns the path of a segment
+ *
+ * \param base: Segment path without "-<n>.rec"
+ * \param segment: Segment number
+ */
+QString Recorder::segmentPath(const QString &base, int segment) {
+    return base + "-" + QString::number(segment) + RECORD_EXTENSION;
+}
+
+/*!
+ * \brief Splits the path of a segment into its base and number
+ *
+ * \param path: Segment path
+ * \param segment: Receives the segment number, 0 if the path
+ * does not end with "-<n>.rec"
+ * \return Segment path without "-<n>.rec"
+ */
+QString Recorder::basePath(const QString &path, int *segment) {
+    QRegularExpressionMatch match = QRegularExpression("^(.*)-(\\d+)"
+                + QRegularExpression::escape(RECORD_EXTENSION) + "$")
+                .match(path);
+    if (segment) *segment = match.hasMatch() ? match.captured(2).toInt() : 0;
+    return match.hasMatch() ? match.captured(1) : path;
+}
+
+/*!
+ * \brief Appends encoded frames to the current segment
+ *
+ * Starts a new segment when the current one is full
+ *
+ * \param frames: Frames encoded with appendFrame()
+ */
+void Recorder::write(QByteArray frames) {
+    if (frames.isEmpty()) return;
+    if (!file.isOpen() || file.size() >= RECORD_SEGMENT_SIZE) {
+        if (!openSegment()) return;
+    }
+    file.write(frames);
+    file.flush();
+}
+
+/*!
+ * \brief Closes the current segment
+ */
+void Recorder::close() {
+    file.close();
+}
+
+/*!
+ * \brief Starts the next segment and writes its header
+ *
+ * Existing segments of the same base are never overwritten
+ *
+ * \return True: Segment opened
+ */
+bool Recorder::openSegment() {
+    file.close();
+    do {
+        file.setFileName(segmentPath(base, ++segment));
+    } while (file.exists());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) return false;
+
+    QByteArray uriBytes = uri.toString().toUtf8();
+    QByteArray header(RECORD_MAGIC, RECORD_MAGIC_SIZE);
+    uchar size[4];
+    qToLittleEndian<quint32>(quint32(uriBytes.size()), size);
+    header.append(reinterpret_cast<const char*>(size), 4);
+    header.append(uriBytes);
+    return file.write(header) == header.size();
+}
@@ -0,0 +1,71 @@
+/*!
+ * \file recorder.h
+ *
+ * Append-only recording of received messages. A recording is a series
+ * of segment files named "<base>-<n>.rec", n counting from 0. All
+ * integers are little-endian.
+ *
+ * Segment header:
+ * - char[8] magic "MSREC001"
+ * - quint32 URI length in bytes
+ * - UTF-8 URI of the recorded source
+ *
+ * Frame:
+ * - qint64 receive time in microseconds since epoch
+ * - quint32 payload size, ORed with \b RECORD_BINARY for binary messages
+ * - payload: UTF-8 text or binary message
+ */
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QUrl>
+#include <QByteArray>
+
+const char RECORD_MAGIC[] = "MSREC001"; /*!< First bytes of each segment */
+const int RECORD_MAGIC_SIZE = 8; /*!< Size of the magic */
+const int RECORD_FRAME_HEADER_SIZE = 12; /*!< Size of the fixed frame fields */
+const quint32 RECORD_BINARY = 0x80000000u; /*!< Set in the payload size
+                                                of binary messages */
+const qint64 RECORD_SEGMENT_SIZE = 64 * 1024 * 1024; /*!< Segments are rotated
+                                                          beyond this size */
+const int RECORD_FLUSH_SIZE = 256 * 1024; /*!< Buffered frames are handed
+                                     to the recorder beyond this size */
+const int RECORD_FLUSH_INTERVAL = 500; /*!< Longest time frames stay
+                                            buffered in milliseconds */
+const QString RECORD_EXTENSION = ".rec"; /*!< Extension of segment files */
+
+/*!
+ * \brief Recorder class
+ *
+ * Writes buffers of encoded frames to segment files on its own thread,
+ * so that the ingestion workers only copy frames into memory. A new
+ * segment is started when the current one exceeds
+ * \b RECORD_SEGMENT_SIZE. Segments are only ever appended to.
+ */
+class Recorder : public QObject {
+    Q_OBJECT
+
+public:
+    Recorder(const QString &base, const QUrl &uri, QObject *parent = 0);
+
+    static void appendFrame(QByteArray &buffer, qint64 time, bool isBinary,
+                            const char *data, int size);
+    static QString segmentPath(const QString &base, int segment);
+    static QString basePath(const QString &path, int *segment = 0);
+
+public slots:
+    void write(QByteArray frames);
+    void close();
+
+private:
+    bool openSegment();
+
+    QString base; /*!< Segment path without the segment number */
+    QUrl uri; /*!< Recorded source, stored in each segment header */
+    QFile file; /*!< Current segment */
+    int segment; /*!< Number of the current segment, -1 before the first */
+};
+
+#endif // RECORDER_H
@@ -0,0 +1,361 @@
+/*!
+ * \file relayserver.cpp
+ */
+#include "relayserver.h"
+#include "monitorwindow.h"
+#include "valueparser.h"
+
+/*!
+ * \brief RelayServer constructor
+ */
+RelayServer::RelayServer(QObject *parent) : QObject(parent),
+    server(new QWebSocketServer(RELAY_NAME, QWebSocketServer::NonSecureMode,
+                                this)),
+    sequence(0), catalogChanged(false), received(0), messagesSent(0),
+    bytesSent(0), heldBack(0) {
+
+    QObject::connect(server, SIGNAL(newConnection()), this,
+                                            SLOT(clientConnected()));
+    QObject::connect(&outputTimer, SIGNAL(timeout()), this,
+                                            SLOT(sendUpdates()));
+    QObject::connect(&catalogTimer, SIGNAL(timeout()), this,
+                                            SLOT(sendCatalog()));
+    QObject::connect(&statsTimer, SIGNAL(timeout()), this,
+                                            SLOT(logStats()));
+}
+
+/*!
+ * \brief RelayServer destructor
+ */
+RelayServer::~RelayServer() {
+    closeSources();
+    server->close();
+}
+
+/*!
+ * \brief Starts serving the downstream screens
+ *
+ * \param port: TCP port
+ * \param rate: Number of updates sent per second
+ * \return True: Server is listening
+ */
+bool RelayServer::listen(quint16 port, int rate) {
+    if (!server->listen(QHostAddress::Any, port)) {
+        qWarning().noquote() << RELAY_LISTEN_ERROR_TEXT.arg(port)
+                                .arg(server->errorString());
+        return false;
+    }
+    rate = qMax(rate, 1);
+    outputTimer.start(qMax(1000 / rate, 1));
+    catalogTimer.start(RELAY_CATALOG_INTERVAL);
+    statsTimer.start(RELAY_STATS_INTERVAL);
+    qInfo().noquote() << RELAY_LISTENING_TEXT.arg(server->serverPort())
+                                             .arg(rate);
+    return true;
+}
+
+/*!
+ * \brief Connects to the upstream sources
+ *
+ * Each source gets its own ingestion worker, thread and sample queue.
+ * With several sources parameter names are qualified as in MonitorWindow.
+ *
+ * \param uris: WebSocket URIs
+ */
+void RelayServer::openSources(const QList<QUrl> &uris) {
+    closeSources();
+    for (const QUrl &sourceUri : uris) {
+        RelaySource source;
+        source.thread = new QThread(this);
+        source.queue = new SampleQueue<Sample>();
+        source.worker = new IngestionWorker(source.queue, uris.size() > 1
+                            ? MonitorWindow::sourcePrefix(sourceUri) : "");
+        source.worker->moveToThread(source.thread);
+        QObject::connect(source.thread, SIGNAL(started()), source.worker,
+                                                    SLOT(start()));
+        QObject::connect(source.thread, SIGNAL(finished()), source.worker,
+                                                    SLOT(deleteLater()));
+        QObject::connect(source.worker, SIGNAL(samplesReady()), this,
+                                                    SLOT(samplesReady()));
+        sources.append(source);
+
+        source.thread->start();
+        QMetaObject::invokeMethod(source.worker, "open", Qt::QueuedConnection,
+                                  Q_ARG(QUrl, sourceUri));
+    }
+}
+
+/*!
+ * \brief Closes all upstream connections and stops their threads
+ */
+void RelayServer::closeSources() {
+    for (const RelaySource &source : sources) {
+        QMetaObject::invokeMethod(source.worker, "closeConnection",
+                                  Qt::BlockingQueuedConnection);
+        source.thread->quit();
+        source.thread->wait();
+        delete source.thread;
+        delete source.queue;
+    }
+    sources.clear();
+}
+
+/*!
+ * \brief Drains the sample queue of the notifying worker
+ */
+void RelayServer::samplesReady() {
+    for (const RelaySource &source : sources) {
+        if (source.worker != sender()) continue;
+        source.queue->acknowledge();
+        Sample sample;
+        while (source.queue->pop(sample)) applySample(sample);
+    }
+}
+
+/*!
+ * \brief Stores the latest value of a parameter and adds it
+ * to the aggregates of the current output interval
+ *
+ * Latency probes are not relayed, they would measure the relay only.
+ * Names too long for a binary record are not listed in the catalog.
+ *
+ * \param sample: Decoded sample
+ */
+void RelayServer::applySample(const Sample &sample) {
+    if (sample.name == "" || sample.name == PROBE_NAME) return;
+    received++;
+
+    bool added;
+    int id = registry.intern(sample.name, &added);
+    if (id >= entries.size()) entries.resize(registry.capacity());
+    RelayEntry &entry = entries[id];
+    if (added) {
+        for (int i = 0; i < RELAY_AGGREGATES; i++) {
+            entry.names[i] = sample.name + RELAY_AGGREGATE_SUFFIXES[i];
+            if (!BinaryEncoder::fits(entry.names[i])) entry.names[i].clear();
+        }
+        entry.isNumeric = false;
+        entry.interval = Aggregate();
+        entry.last = Aggregate();
+        if (BinaryEncoder::fits(sample.name)) {
+            catalog << sample.name;
+            catalogChanged = true;
+        }
+    }
+    if (sample.hasNumber) {
+        if (!entry.isNumeric) {
+            entry.isNumeric = true;
+            for (const QString &name : entry.names) {
+                if (name != "") catalog << name;
+            }
+            catalogChanged = true;
+        }
+        entry.interval.add(sample.number);
+    }
+
+    if (!(registry.slot(id).flags & PARAM_CHANGED)) changed.append(id);
+    registry.update(id, sample);
+}
+
+/*!
+ * \brief Sends the changed parameters to each client
+ *
+ * Clients that are up to date share one frame of the parameters changed
+ * since the last output, unless they subscribed to names. A client that
+ * was held back gets every parameter changed since its last update.
+ */
+void RelayServer::sendUpdates() {
+    quint64 previous = sequence;
+    for (int id : changed) {
+        ParameterSlot &slot = registry.slot(id);
+        slot.flags &= ~PARAM_CHANGED;
+        sequence = qMax(sequence, slot.sequence);
+        RelayEntry &entry = entries[id];
+        entry.last = entry.interval;
+        entry.interval = Aggregate();
+    }
+
+    QByteArray shared;
+    for (auto i = clients.begin(); i != clients.end(); ++i) {
+        RelayClient &client = i.value();
+        if (client.sequence == sequence) continue;
+        if (i.key()->bytesToWrite() > RELAY_BUFFER_MAX) {
+            heldBack++;
+            continue;
+        }
+
+        QByteArray frame;
+        if (client.sequence == previous && !client.subscribed) {
+            if (shared.isEmpty()) shared = encode(changed, 0);
+            frame = shared;
+        }
+        else if (client.sequence == previous) {
+            frame = encode(changed, &client);
+        }
+        else {
+            pending.clear();
+            for (int id = 0; id < registry.capacity(); id++) {
+                if (registry.contains(id)
+                        && registry.slot(id).sequence > client.sequence) {
+                    pending.append(id);
+                }
+            }
+            frame = encode(pending, client.subscribed ? &client : 0);
+        }
+        client.sequence = sequence;
+        if (!frame.isEmpty()) send(i.key(), frame);
+    }
+    changed.clear();
+}
+
+/*!
+ * \brief Encodes the values of parameters as a binary frame
+ *
+ * \param ids: Parameter IDs
+ * \param client: Client whose subscription filters the parameters,
+ * 0 for all parameters without aggregates
+ * \return Binary frame, empty if no parameter is included
+ */
+QByteArray RelayServer::encode(const QVector<int> &ids,
+                               const RelayClient *client) {
+    BinaryEncoder encoder;
+    for (int id : ids) addRecords(encoder, id, client);
+    return encoder.count() ? encoder.finish() : QByteArray();
+}
+
+/*!
+ * \brief Adds the latest value of a parameter and its subscribed
+ * aggregates to a binary frame
+ *
+ * Values are relayed as received, text as text and binary numbers
+ * as numbers, so that screens show them exactly as sent upstream.
+ * Aggregates are encoded as numbers with the unit of the latest value.
+ *
+ * \param encoder: Frame being built
+ * \param id: Parameter ID
+ * \param client: Client whose subscription filters the records,
+ * 0 for the value only
+ */
+void RelayServer::addRecords(BinaryEncoder &encoder, int id,
+                             const RelayClient *client) {
+    const ParameterSlot &slot = registry.slot(id);
+    const RelayEntry &entry = entries[id];
+    if (!client || client->names.contains(slot.name)) {
+        if (slot.format == SAMPLE_FLOAT) {
+            encoder.addDouble(slot.name, slot.number, slot.unit,
+                              slot.timestamp);
+        }
+        else if (slot.format == SAMPLE_INTEGER) {
+            encoder.addInteger(slot.name, qint64(slot.number), slot.unit,
+                               slot.timestamp);
+        }
+        else encoder.addString(slot.name, slot.value, slot.timestamp);
+    }
+    if (!client || !entry.last.count) return;
+
+    double number;
+    QStringView unit = slot.unit;
+    if (slot.format == SAMPLE_TEXT) {
+        ValueParser::parse(slot.value, number, unit);
+    }
+    const double values[RELAY_AGGREGATES] = {entry.last.minimum,
+                                             entry.last.maximum,
+                                             entry.last.mean};
+    for (int i = 0; i < RELAY_AGGREGATES; i++) {
+        if (entry.names[i] != "" && client->names.contains(entry.names[i])) {
+            encoder.addDouble(entry.names[i], values[i], unit.toString(),
+                              slot.timestamp);
+        }
+    }
+}
+
+/*!
+ * \brief Sends a binary frame to a client
+ *
+ * \param socket: Client socket
+ * \param frame: Binary frame
+ */
+void RelayServer::send(QWebSocket *socket, const QByteArray &frame) {
+    socket->sendBinaryMessage(frame);
+    messagesSent++;
+    bytesSent += quint64(frame.size());
+}
+
+/*!
+ * \brief Accepts new clients
+ *
+ * A new client gets the latest value of every parameter
+ * on the next output
+ */
+void RelayServer::clientConnected() {
+    while (server->hasPendingConnections()) {
+        QWebSocket *socket = server->nextPendingConnection();
+        QObject::connect(socket, SIGNAL(textMessageReceived(QString)), this,
+                         SLOT(messageReceived(QString)));
+        QObject::connect(socket, SIGNAL(disconnected()), this,
+                         SLOT(clientDisconnected()));
+
+        RelayClient client;
+        client.subscribed = false;
+        client.sequence = 0;
+        clients.insert(socket, client);
+        qInfo().noquote() << RELAY_CONNECTED_TEXT.arg(clients.size());
+    }
+}
+
+/*!
+ * \brief Removes a disconnected client
+ */
+void RelayServer::clientDisconnected() {
+    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
+    if (!socket || !clients.remove(socket)) return;
+    socket->deleteLater();
+    qInfo().noquote() << RELAY_DISCONNECTED_TEXT.arg(clients.size());
+}
+
+/*!
+ * \brief Handles subscriptions of a client
+ *
+ * A subscribing client gets the catalog and the latest value of each
+ * subscribed name on the next output. Other messages are ignored.
+ *
+ * \param message: Received message
+ */
+void RelayServer::messageReceived(QString message) {
+    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
+    QStringList names;
+    if (!socket || !clients.contains(socket)
+            || !Subscription::decode(message, JSON_SUBSCRIBE, names)) return;
+
+    RelayClient &client = clients[socket];
+    client.subscribed = !names.isEmpty();
+    client.names = QSet<QString>(names.begin(), names.end());
+    client.sequence = 0;
+    if (client.subscribed) {
+        socket->sendTextMessage(Subscription::encode(JSON_CATALOG, catalog));
+    }
+}
+
+/*!
+ * \brief Sends the catalog to subscribed clients if it has changed
+ */
+void RelayServer::sendCatalog() {
+    if (!catalogChanged) return;
+    catalogChanged = false;
+    QString message = Subscription::encode(JSON_CATALOG, catalog);
+    for (auto i = clients.begin(); i != clients.end(); ++i) {
+        if (i.value().subscribed) i.key()->sendTextMessage(message);
+    }
+}
+
+/*!
+ * \brief Logs the counters since the last log and resets them
+ */
+void RelayServer::logStats() {
+    qInfo().noquote() << RELAY_STATS_TEXT.arg(clients.size()).arg(received)
+                         .arg(messagesSent).arg(bytesSent).arg(heldBack);
+    received = 0;
+    messagesSent = 0;
+    bytesSent = 0;
+    heldBack = 0;
+}
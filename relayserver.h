@@ -0,0 +1,135 @@
+/*!
+ * \file relayserver.h
+ */
+#ifndef RELAYSERVER_H
+#define RELAYSERVER_H
+
+#include <QObject>
+#include <QUrl>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QThread>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include "ingestionworker.h"
+#include "parameterregistry.h"
+#include "rollingstats.h"
+
+const quint16 RELAY_PORT = 8081; /*!< Default port served to the screens */
+const int RELAY_RATE = 10; /*!< Default number of updates sent per second */
+const int RELAY_CATALOG_INTERVAL = 5000; /*!< Interval for sending a changed
+                                              catalog in milliseconds */
+const int RELAY_STATS_INTERVAL = 10000; /*!< Interval for logging
+                                             statistics in milliseconds */
+const qint64 RELAY_BUFFER_MAX = 1024 * 1024; /*!< Updates are held back from
+                    a client while more bytes wait to be written to it */
+const QString RELAY_NAME = "MonitorScreen relay"; /*!< Server name */
+const int RELAY_AGGREGATES = 3; /*!< Number of aggregates per parameter */
+const QString RELAY_AGGREGATE_SUFFIXES[RELAY_AGGREGATES] =
+    {".min", ".max", ".mean"};
+/*!< Appended to a parameter name for its aggregates over the last
+     output interval */
+const QString RELAY_LISTENING_TEXT = "Relaying to port %1 at %2 updates/s";
+/*!< Logged when the server is listening */
+const QString RELAY_LISTEN_ERROR_TEXT = "Cannot listen on port %1: %2";
+/*!< Logged when the server cannot listen */
+const QString RELAY_CONNECTED_TEXT = "Client connected, %1 clients";
+/*!< Logged when a client connects */
+const QString RELAY_DISCONNECTED_TEXT = "Client disconnected, %1 clients";
+/*!< Logged when a client disconnects */
+const QString RELAY_STATS_TEXT = "Clients: %1, received %2 samples, "
+        "sent %3 messages and %4 bytes, held back %5 updates";
+/*!< Logged every \b RELAY_STATS_INTERVAL */
+
+/*!
+ * \brief Upstream connection of the relay
+ */
+struct RelaySource {
+    QThread *thread; /*!< Thread running the ingestion worker */
+    IngestionWorker *worker; /*!< Owns the WebSocket connection */
+    SampleQueue<Sample> *queue; /*!< Samples decoded by the worker */
+};
+
+/*!
+ * \brief State kept for each relayed parameter
+ */
+struct RelayEntry {
+    QString names[RELAY_AGGREGATES]; /*!< Names of the aggregates, empty
+                                          if too long to be encoded */
+    bool isNumeric; /*!< Determines, whether a numeric value was received */
+    Aggregate interval; /*!< Values received since the last output */
+    Aggregate last; /*!< Values of the last output interval
+                         the parameter changed in */
+};
+
+/*!
+ * \brief Downstream screen connected to the relay
+ */
+struct RelayClient {
+    bool subscribed; /*!< Determines, whether the client subscribed
+                          to a list of names */
+    QSet<QString> names; /*!< Subscribed names, aggregates included */
+    quint64 sequence; /*!< Registry sequence number sent so far */
+};
+
+/*!
+ * \brief RelayServer class
+ *
+ * Headless mode taking the high-rate parsing load off many screens.
+ * Upstream sources are decoded by ingestion workers as in MonitorWindow,
+ * only the latest value of each parameter is kept. At a fixed output
+ * rate the parameters changed since a client's last update are sent to
+ * it in one binary frame. Clients may subscribe to aggregates of the last
+ * output interval by appending \b RELAY_AGGREGATE_SUFFIXES to a name.
+ * A client whose socket does not keep up is skipped and catches up
+ * with the latest values later.
+ */
+class RelayServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RelayServer(QObject *parent = 0);
+    ~RelayServer();
+
+    bool listen(quint16 port, int rate);
+    void openSources(const QList<QUrl> &uris);
+    void closeSources();
+
+private slots:
+    void samplesReady();
+    void clientConnected();
+    void clientDisconnected();
+    void messageReceived(QString message);
+    void sendUpdates();
+    void sendCatalog();
+    void logStats();
+
+private:
+    void applySample(const Sample &sample);
+    void addRecords(BinaryEncoder &encoder, int id,
+                    const RelayClient *client);
+    QByteArray encode(const QVector<int> &ids, const RelayClient *client);
+    void send(QWebSocket *socket, const QByteArray &frame);
+
+    QWebSocketServer *server; /*!< Serves the downstream screens */
+    QVector<RelaySource> sources; /*!< Upstream connections */
+    QHash<QWebSocket*, RelayClient> clients; /*!< Connected screens */
+    ParameterRegistry registry; /*!< Latest value of each parameter */
+    QVector<RelayEntry> entries; /*!< Aggregates of each parameter ID */
+    QVector<int> changed; /*!< IDs changed since the last output */
+    QVector<int> pending; /*!< Reused for the IDs sent to a lagging client */
+    quint64 sequence; /*!< Registry sequence number of the last output */
+    QStringList catalog; /*!< Names of all parameters and aggregates */
+    bool catalogChanged; /*!< Determines, whether the catalog is sent
+                              on the next catalog interval */
+    QTimer outputTimer; /*!< Triggers the output of updates */
+    QTimer catalogTimer; /*!< Triggers sending the catalog */
+    QTimer statsTimer; /*!< Triggers logging statistics */
+    quint64 received; /*!< Samples received since the last log */
+    quint64 messagesSent; /*!< Messages sent since the last log */
+    quint64 bytesSent; /*!< Bytes sent since the last log */
+    quint64 heldBack; /*!< Updates held back since the last log */
+};
+
+#endif // RELAYSERVER_H
@@ -0,0 +1,181 @@
+/*!
+ * \file replayer.cpp
+ */
+#include "replayer.h"
+#include <QtEndian>
+#include <limits>
+#include <cstring>
+
+/*!
+ * \brief Replayer constructor
+ */
+Replayer::Replayer(QObject *parent) : QObject(parent), segment(0), data(0),
+    size(0), position(0), speed(1), firstTime(-1), frames(0),
+    paused(false) {
+    timer.setSingleShot(true);
+    QObject::connect(&timer, SIGNAL(timeout()), this, SLOT(next()));
+}
+
+/*!
+ * \brief Opens a recording
+ *
+ * \param path: Path of a segment, replay starts from this segment
+ * and continues with the following ones
+ * \return True: Segment is a valid recording
+ */
+bool Replayer::open(const QString &path) {
+    stop();
+    base = Recorder::basePath(path, &segment);
+    return mapSegment(segment);
+}
+
+/*!
+ * \brief Starts emitting the frames of the opened recording
+ *
+ * \param newSpeed: Speed factor, e.g. 1 for the recorded pace,
+ * 0 for maximum speed
+ */
+void Replayer::start(double newSpeed) {
+    speed = newSpeed;
+    firstTime = -1;
+    frames = 0;
+    paused = false;
+    clock.start();
+    timer.start(0);
+}
+
+/*!
+ * \brief Stops the replay and unmaps the recording
+ */
+void Replayer::stop() {
+    timer.stop();
+    paused = false;
+    if (data) file.unmap(const_cast<uchar*>(data));
+    file.close();
+    data = 0;
+    size = 0;
+    position = 0;
+}
+
+/*!
+ * \brief Holds the replay back after the current frame
+ *
+ * Called by the consumer of the frames while it falls behind
+ */
+void Replayer::pause() {
+    if (!data) return;
+    paused = true;
+    timer.stop();
+}
+
+/*!
+ * \brief Continues a paused replay
+ */
+void Replayer::resume() {
+    if (!paused || !data) return;
+    paused = false;
+    timer.start(0);
+}
+
+/*!
+ * \brief Returns the source URI stored in a segment header
+ *
+ * \param path: Segment path
+ * \return Recorded URI, empty if the file is not a recording
+ */
+QUrl Replayer::readUri(const QString &path) {
+    QFile segmentFile(path);
+    if (!segmentFile.open(QIODevice::ReadOnly)) return QUrl();
+    QByteArray header = segmentFile.read(RECORD_MAGIC_SIZE + 4);
+    if (header.size() < RECORD_MAGIC_SIZE + 4
+            || !header.startsWith(RECORD_MAGIC)) return QUrl();
+    quint32 length = qFromLittleEndian<quint32>(
+                reinterpret_cast<const uchar*>(header.constData())
+                + RECORD_MAGIC_SIZE);
+    return QUrl(QString::fromUtf8(segmentFile.read(length)));
+}
+
+/*!
+ * \brief Emits the next frames
+ *
+ * At a set speed frames are emitted once they are due, at maximum
+ * speed \b REPLAY_BATCH frames per call. A frame cut short by an
+ * interrupted recording ends its segment.
+ */
+void Replayer::next() {
+    for (int count = 0; count < REPLAY_BATCH; count++) {
+        if (position + RECORD_FRAME_HEADER_SIZE > size) {
+            if (!mapSegment(segment + 1)) {
+                finish();
+                return;
+            }
+            continue;
+        }
+        const uchar *header = data + position;
+        qint64 time = qFromLittleEndian<qint64>(header);
+        quint32 length = qFromLittleEndian<quint32>(header + 8);
+        bool isBinary = length & RECORD_BINARY;
+        length &= ~RECORD_BINARY;
+        if (position + RECORD_FRAME_HEADER_SIZE + length > size) {
+            position = size;
+            continue;
+        }
+
+        if (speed > 0) {
+            if (firstTime < 0) firstTime = time;
+            qint64 wait = qint64((time - firstTime) / speed / 1000)
+                          - clock.elapsed();
+            if (wait > 0) {
+                timer.start(int(qMin(wait, qint64(
+                                std::numeric_limits<int>::max()))));
+                return;
+            }
+        }
+
+        const char *payload = reinterpret_cast<const char*>(
+                    header + RECORD_FRAME_HEADER_SIZE);
+        position += RECORD_FRAME_HEADER_SIZE + length;
+        frames++;
+        if (isBinary) emit binaryFrame(QByteArray(payload, int(length)));
+        else emit textFrame(QString::fromUtf8(payload, int(length)));
+        if (!data || paused) return;
+    }
+    timer.start(0);
+}
+
+/*!
+ * \brief Maps a segment of the opened recording
+ *
+ * \param number: Segment number
+ * \return True: Segment exists and is a valid recording
+ */
+bool Replayer::mapSegment(int number) {
+    if (data) file.unmap(const_cast<uchar*>(data));
+    file.close();
+    data = 0;
+    size = 0;
+    position = 0;
+
+    file.setFileName(Recorder::segmentPath(base, number));
+    if (!file.open(QIODevice::ReadOnly)
+            || file.size() < RECORD_MAGIC_SIZE + 4) return false;
+    data = file.map(0, file.size());
+    if (!data || memcmp(data, RECORD_MAGIC, RECORD_MAGIC_SIZE) != 0) {
+        stop();
+        return false;
+    }
+    segment = number;
+    size = file.size();
+    position = RECORD_MAGIC_SIZE + 4
+               + qFromLittleEndian<quint32>(data + RECORD_MAGIC_SIZE);
+    return true;
+}
+
+/*!
+ * \brief Ends the replay and reports its throughput
+ */
+void Replayer::finish() {
+    qint64 nanoseconds = clock.nsecsElapsed();
+    stop();
+    emit finished(frames, nanoseconds);
+}
@@ -0,0 +1,67 @@
+/*!
+ * \file replayer.h
+ */
+#ifndef REPLAYER_H
+#define REPLAYER_H
+
+#include <QObject>
+#include <QFile>
+#include <QUrl>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "recorder.h"
+
+const int REPLAY_BATCH = 1000; /*!< Frames replayed per pass of the event
+                                    loop, so that replay can be stopped */
+
+/*!
+ * \brief Replayer class
+ *
+ * Memory-maps the segments of a recording one after another and emits
+ * their frames in order, either at the recorded pace scaled by a speed
+ * factor or as fast as they are consumed. At maximum speed the consumer
+ * pauses the replay while it falls behind, so no frame is dropped.
+ * Connected directly to an ingestion worker, frames take the same path
+ * as received messages.
+ */
+class Replayer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit Replayer(QObject *parent = 0);
+
+    bool open(const QString &path);
+    void start(double newSpeed);
+    void stop();
+    void pause();
+    void resume();
+
+    static QUrl readUri(const QString &path);
+
+signals:
+    void textFrame(QString message);
+    void binaryFrame(QByteArray message);
+    void finished(quint64 count, qint64 nanoseconds);
+
+private slots:
+    void next();
+
+private:
+    bool mapSegment(int number);
+    void finish();
+
+    QString base; /*!< Segment path without the segment number */
+    int segment; /*!< Number of the mapped segment */
+    QFile file; /*!< Mapped segment */
+    const uchar *data; /*!< Mapped segment bytes */
+    qint64 size; /*!< Size of the mapped segment */
+    qint64 position; /*!< Offset of the next frame */
+    double speed; /*!< Replay speed factor, 0 for maximum speed */
+    qint64 firstTime; /*!< Receive time of the first frame, -1 if none */
+    QElapsedTimer clock; /*!< Time since the replay started */
+    QTimer timer; /*!< Schedules the next frames */
+    quint64 frames; /*!< Number of replayed frames */
+    bool paused; /*!< Determines, whether the replay waits for resume() */
+};
+
+#endif // REPLAYER_H
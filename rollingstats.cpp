@@ -0,0 +1,114 @@
+/*!
+ * \file rollingstats.cpp
+ */
+#include "rollingstats.h"
+#include <cmath>
+
+/*!
+ * \brief Adds a value using Welford's algorithm
+ *
+ * \param value: Numeric value
+ */
+void Aggregate::add(double value) {
+    if (!count) {
+        minimum = value;
+        maximum = value;
+    }
+    else {
+        minimum = qMin(minimum, value);
+        maximum = qMax(maximum, value);
+    }
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+/*!
+ * \brief Adds the values of another aggregate using Chan's formula
+ *
+ * \param other: Aggregate to be merged
+ */
+void Aggregate::merge(const Aggregate &other) {
+    if (!other.count) return;
+    if (!count) {
+        *this = other;
+        return;
+    }
+    quint64 total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * count * other.count / total;
+    minimum = qMin(minimum, other.minimum);
+    maximum = qMax(maximum, other.maximum);
+    count = total;
+}
+
+/*!
+ * \brief Returns the population standard deviation
+ */
+double Aggregate::standardDeviation() const {
+    return count ? std::sqrt(m2 / count) : 0;
+}
+
+/*!
+ * \brief RollingStats constructor
+ */
+RollingStats::RollingStats() {}
+
+/*!
+ * \brief Adds a value to the current bucket of each window
+ *
+ * \param time: Receive time in milliseconds, not decreasing
+ * \param value: Numeric value
+ */
+void RollingStats::add(qint64 time, double value) {
+    if (buckets.isEmpty()) {
+        buckets.fill({-1, Aggregate()}, ROLLING_WINDOWS * ROLLING_BUCKETS);
+    }
+    RollingBucket *ring = buckets.data();
+    for (int i = 0; i < ROLLING_WINDOWS; i++, ring += ROLLING_BUCKETS) {
+        qint64 slot = time * ROLLING_BUCKETS / ROLLING_WINDOW_LENGTHS[i];
+        RollingBucket &bucket = ring[slot % ROLLING_BUCKETS];
+        if (bucket.slot != slot) {
+            bucket.slot = slot;
+            bucket.aggregate = Aggregate();
+        }
+        bucket.aggregate.add(value);
+    }
+}
+
+/*!
+ * \brief Removes all values and frees the buckets
+ */
+void RollingStats::clear() {
+    buckets.clear();
+    buckets.squeeze();
+}
+
+/*!
+ * \brief Checks if no value was added
+ */
+bool RollingStats::isEmpty() const {
+    return buckets.isEmpty();
+}
+
+/*!
+ * \brief Returns the aggregate of a window
+ *
+ * \param index: Window index in \b ROLLING_WINDOW_LENGTHS
+ * \param time: Current time in milliseconds
+ * \return Aggregate of the buckets within the window
+ */
+Aggregate RollingStats::window(int index, qint64 time) const {
+    Aggregate result;
+    if (buckets.isEmpty()) return result;
+    qint64 slot = time * ROLLING_BUCKETS / ROLLING_WINDOW_LENGTHS[index];
+    const RollingBucket *ring = buckets.constData() + index * ROLLING_BUCKETS;
+    for (int i = 0; i < ROLLING_BUCKETS; i++) {
+        if (ring[i].slot > slot - ROLLING_BUCKETS && ring[i].slot <= slot) {
+            result.merge(ring[i].aggregate);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,63 @@
+/*!
+ * \file rollingstats.h
+ */
+#ifndef ROLLINGSTATS_H
+#define ROLLINGSTATS_H
+
+#include <QVector>
+#include <QtGlobal>
+
+const int ROLLING_WINDOWS = 3; /*!< Number of sliding windows */
+const qint64 ROLLING_WINDOW_LENGTHS[ROLLING_WINDOWS] = {1000, 60000, 900000};
+/*!< Length of each window in milliseconds */
+const int ROLLING_BUCKETS = 10; /*!< Buckets per window, a window covers
+                                     between 90% and 100% of its length */
+
+/*!
+ * \brief Count, mean, variance, minimum and maximum of numeric values
+ */
+struct Aggregate {
+    quint64 count = 0; /*!< Number of values */
+    double mean = 0; /*!< Mean of the values */
+    double m2 = 0; /*!< Sum of squared differences from the mean */
+    double minimum = 0; /*!< Smallest value */
+    double maximum = 0; /*!< Largest value */
+
+    void add(double value);
+    void merge(const Aggregate &other);
+    double standardDeviation() const;
+};
+
+/*!
+ * \brief Aggregate of the values received in one time slot
+ */
+struct RollingBucket {
+    qint64 slot; /*!< Receive time divided by the bucket length,
+                      -1 if the bucket is unused */
+    Aggregate aggregate; /*!< Values of the slot */
+};
+
+/*!
+ * \brief RollingStats class
+ *
+ * Keeps the aggregates of a parameter over the windows in
+ * \b ROLLING_WINDOW_LENGTHS. Each window is a ring of \b ROLLING_BUCKETS
+ * time slots, so memory stays fixed at any sample rate and adding
+ * a value updates one bucket per window. Buckets are allocated on
+ * the first value.
+ */
+class RollingStats {
+
+public:
+    RollingStats();
+
+    void add(qint64 time, double value);
+    void clear();
+    bool isEmpty() const;
+    Aggregate window(int index, qint64 time) const;
+
+private:
+    QVector<RollingBucket> buckets; /*!< Rings of all windows in order */
+};
+
+#endif // ROLLINGSTATS_H
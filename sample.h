@@ -0,0 +1,40 @@
+/*!
+ * \file sample.h
+ */
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <QString>
+#include "valueparser.h"
+
+const quint8 SAMPLE_TEXT = 0; /*!< Value holds the displayed text */
+const quint8 SAMPLE_FLOAT = 1; /*!< Displayed text is formatted from
+                                    number and unit when needed */
+const quint8 SAMPLE_INTEGER = 2; /*!< Like \b SAMPLE_FLOAT,
+                                      without fraction */
+
+/*!
+ * \brief Single decoded parameter update
+ */
+struct Sample {
+    QString name; /*!< Parameter name */
+    QString value; /*!< Parameter value as displayed, empty unless
+                        format is \b SAMPLE_TEXT */
+    QString time; /*!< Timestamp as sent by the server */
+    QString unit; /*!< Unit of a formatted number */
+    qint64 timestamp = 0; /*!< Microseconds since epoch, 0 if not known */
+    qint64 received = 0; /*!< Receive time in microseconds since epoch */
+    double number = 0; /*!< Numeric value, valid if hasNumber is set */
+    bool hasNumber = false; /*!< Determines, whether the value is numeric */
+    quint8 format = SAMPLE_TEXT; /*!< How the value is displayed */
+
+    /*!
+     * \brief Returns the value as displayed
+     */
+    QString text() const {
+        if (format == SAMPLE_TEXT) return value;
+        return ValueParser::format(number, unit, format == SAMPLE_INTEGER);
+    }
+};
+
+#endif // SAMPLE_H
@@ -0,0 +1,122 @@
+/*!
+ * \file samplequeue.h
+ */
+#ifndef SAMPLEQUEUE_H
+#define SAMPLEQUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+const int SAMPLE_QUEUE_CAPACITY = 65536; /*!< Number of samples the queue
+                                              holds, must be a power of two */
+const int CACHE_LINE_SIZE = 64; /*!< Used for keeping the producer and
+                                     consumer indices on separate lines */
+
+/*!
+ * \brief Lock-free single producer, single consumer ring buffer
+ *
+ * The ingestion thread pushes decoded items and the GUI thread pops them.
+ * Neither side ever blocks: a full queue rejects the item and the producer
+ * decides what to do with it.
+ */
+template <typename T>
+class SampleQueue {
+
+public:
+    /*!
+     * \brief SampleQueue constructor
+     *
+     * \param capacity: Queue size, must be a power of two
+     */
+    explicit SampleQueue(size_t capacity = SAMPLE_QUEUE_CAPACITY) :
+        buffer(capacity), mask(capacity - 1), head(0), tail(0),
+        notifyPending(false) {}
+
+    /*!
+     * \brief Appends an item to the queue, called by the producer only
+     *
+     * \param item: Item to be appended
+     * \return True: Item was appended, false: queue is full
+     */
+    bool push(const T &item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == buffer.size()) {
+            return false;
+        }
+        buffer[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Appends items to the queue, called by the producer only
+     *
+     * All appended items become visible to the consumer at once
+     *
+     * \param items: Items to be appended
+     * \param count: Number of items
+     * \return Number of items appended, less than count if the queue is full
+     */
+    size_t push(const T *items, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t space = buffer.size() - (t - head.load(std::memory_order_acquire));
+        if (count > space) count = space;
+
+        for (size_t i = 0; i < count; i++) buffer[(t + i) & mask] = items[i];
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    /*!
+     * \brief Removes the oldest item from the queue,
+     * called by the consumer only
+     *
+     * \param item: Receives the removed item
+     * \return True: Item was removed, false: queue is empty
+     */
+    bool pop(T &item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(buffer[h & mask]);
+        buffer[h & mask] = T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Returns the number of queued items
+     */
+    size_t size() const {
+        return tail.load(std::memory_order_acquire)
+                - head.load(std::memory_order_acquire);
+    }
+
+    /*!
+     * \brief Marks the queue as having unread items, called by the producer
+     *
+     * \return True: Consumer has to be notified
+     */
+    bool requestNotify() {
+        return !notifyPending.exchange(true, std::memory_order_acq_rel);
+    }
+
+    /*!
+     * \brief Allows the next push to notify the consumer again,
+     * called by the consumer before draining the queue
+     */
+    void acknowledge() {
+        notifyPending.store(false, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> buffer; /*!< Item storage */
+    const size_t mask; /*!< Used for wrapping indices around the buffer */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head; /*!< Next item
+                                                            to be read */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail; /*!< Next free slot */
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> notifyPending; /*!< Set while
+                                            the consumer has been notified */
+};
+
+#endif // SAMPLEQUEUE_H
@@ -0,0 +1,136 @@
+/*!
+ * \file statesnapshot.cpp
+ */
+#include "statesnapshot.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+/*!
+ * \brief StateSnapshot constructor
+ *
+ * \param path: Snapshot file
+ */
+StateSnapshot::StateSnapshot(const QString &path, QObject *parent)
+    : QObject(parent), path(path) {}
+
+/*!
+ * \brief Encodes the parameters and the view state
+ *
+ * \param registry: Parameters to be stored
+ * \param selected: Selected parameter name, empty if none
+ * \param gridMode: Determines, whether grid mode is enabled
+ * \return Snapshot in the format of statesnapshot.h
+ */
+QByteArray StateSnapshot::encode(const ParameterRegistry &registry,
+                                 const QString &selected, bool gridMode) {
+    QByteArray buffer(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    uchar header[8];
+    qToLittleEndian<quint32>(gridMode ? SNAPSHOT_GRID_MODE : 0, header);
+    qToLittleEndian<quint32>(quint32(registry.count()), header + 4);
+    buffer.append(reinterpret_cast<const char*>(header), 8);
+    appendString(buffer, selected);
+
+    for (int id = 0; id < registry.capacity(); id++) {
+        if (!registry.contains(id)) continue;
+        const ParameterSlot &slot = registry.slot(id);
+        uchar times[16];
+        qToLittleEndian<qint64>(slot.timestamp, times);
+        qToLittleEndian<qint64>(slot.received, times + 8);
+        buffer.append(reinterpret_cast<const char*>(times), 16);
+        appendString(buffer, slot.name);
+        appendString(buffer, slot.text());
+        appendString(buffer, slot.time);
+    }
+    return buffer;
+}
+
+/*!
+ * \brief Reads a snapshot
+ *
+ * \param path: Snapshot file
+ * \param state: Receives the stored state
+ * \return True: File exists and is a valid snapshot
+ */
+bool StateSnapshot::load(const QString &path, SnapshotState &state) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)
+            || file.size() < SNAPSHOT_MAGIC_SIZE + 8) return false;
+    const uchar *data = file.map(0, file.size());
+    if (!data) return false;
+    const uchar *end = data + file.size();
+    bool valid = memcmp(data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) == 0;
+
+    const uchar *p = data + SNAPSHOT_MAGIC_SIZE;
+    quint32 flags = qFromLittleEndian<quint32>(p);
+    quint32 count = qFromLittleEndian<quint32>(p + 4);
+    p += 8;
+    valid = valid && readString(p, end, state.selected);
+    state.gridMode = flags & SNAPSHOT_GRID_MODE;
+    state.samples.clear();
+    if (valid) state.samples.reserve(int(qMin<qint64>(count, end - p)));
+
+    for (quint32 i = 0; valid && i < count; i++) {
+        Sample sample;
+        valid = end - p >= 16;
+        if (!valid) break;
+        sample.timestamp = qFromLittleEndian<qint64>(p);
+        sample.received = qFromLittleEndian<qint64>(p + 8);
+        p += 16;
+        valid = readString(p, end, sample.name)
+                && readString(p, end, sample.value)
+                && readString(p, end, sample.time);
+        if (valid) state.samples.append(sample);
+    }
+    file.unmap(const_cast<uchar*>(data));
+    return valid;
+}
+
+/*!
+ * \brief Replaces the snapshot file
+ *
+ * \param snapshot: Snapshot encoded with encode()
+ */
+void StateSnapshot::write(QByteArray snapshot) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(snapshot);
+    file.commit();
+}
+
+/*!
+ * \brief Appends a length-prefixed UTF-8 string
+ *
+ * \param buffer: Snapshot being encoded
+ * \param text: String to be appended
+ */
+void StateSnapshot::appendString(QByteArray &buffer, const QString &text) {
+    QByteArray bytes = text.toUtf8();
+    uchar size[4];
+    qToLittleEndian<quint32>(quint32(bytes.size()), size);
+    buffer.append(reinterpret_cast<const char*>(size), 4);
+    buffer.append(bytes);
+}
+
+/*!
+ * \brief Reads a length-prefixed UTF-8 string
+ *
+ * \param data: Position in the snapshot, moved past the string
+ * \param end: End of the snapshot
+ * \param text: Receives the string
+ * \return True: String lies within the snapshot
+ */
+bool StateSnapshot::readString(const uchar *&data, const uchar *end,
+                               QString &text) {
+    if (end - data < 4) return false;
+    quint32 size = qFromLittleEndian<quint32>(data);
+    data += 4;
+    if (quint64(end - data) < size) return false;
+    text = QString::fromUtf8(reinterpret_cast<const char*>(data), int(size));
+    data += size;
+    return true;
+}
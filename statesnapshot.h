@@ -0,0 +1,79 @@
+/*!
+ * \file statesnapshot.h
+ *
+ * Snapshot of the displayed state, restored on startup before the
+ * sources connect. All integers are little-endian.
+ *
+ * Header:
+ * - char[8] magic "MSSNAP01"
+ * - quint32 flags, \b SNAPSHOT_GRID_MODE
+ * - quint32 number of parameters
+ * - string: selected parameter name, empty if none
+ *
+ * Parameter:
+ * - qint64 timestamp in microseconds since epoch, 0 if not known
+ * - qint64 receive time in microseconds since epoch
+ * - string: name, value, time
+ *
+ * String:
+ * - quint32 length in bytes
+ * - UTF-8 text
+ */
+#ifndef STATESNAPSHOT_H
+#define STATESNAPSHOT_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include "sample.h"
+#include "parameterregistry.h"
+
+const char SNAPSHOT_MAGIC[] = "MSSNAP01"; /*!< First bytes of a snapshot */
+const int SNAPSHOT_MAGIC_SIZE = 8; /*!< Size of the magic */
+const quint32 SNAPSHOT_GRID_MODE = 0x1; /*!< Flag set when grid mode
+                                             is enabled */
+const int SNAPSHOT_INTERVAL = 10000; /*!< Interval for writing a changed
+                                          snapshot in milliseconds */
+const QString SNAPSHOT_FILE_NAME = "snapshot.mss"; /*!< Snapshot file in
+                                        the application data directory */
+
+/*!
+ * \brief State restored from a snapshot
+ */
+struct SnapshotState {
+    QString selected; /*!< Selected parameter name, empty if none */
+    bool gridMode = false; /*!< Determines, whether grid mode is enabled */
+    QVector<Sample> samples; /*!< Last value of each parameter */
+};
+
+/*!
+ * \brief StateSnapshot class
+ *
+ * Encodes the parameter registry on the GUI thread, which only copies
+ * strings, and writes it on a background thread. The file is replaced
+ * atomically, so a crash while writing keeps the previous snapshot.
+ * Loading reads the whole file with a single mapping.
+ */
+class StateSnapshot : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StateSnapshot(const QString &path, QObject *parent = 0);
+
+    static QByteArray encode(const ParameterRegistry &registry,
+                             const QString &selected, bool gridMode);
+    static bool load(const QString &path, SnapshotState &state);
+
+public slots:
+    void write(QByteArray snapshot);
+
+private:
+    static void appendString(QByteArray &buffer, const QString &text);
+    static bool readString(const uchar *&data, const uchar *end,
+                           QString &text);
+
+    QString path; /*!< Snapshot file */
+};
+
+#endif // STATESNAPSHOT_H
@@ -0,0 +1,106 @@
+/*!
+ * \file subscription.cpp
+ */
+#include "subscription.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+/*!
+ * \brief Builds a control message
+ *
+ * \param key: \b JSON_SUBSCRIBE or \b JSON_CATALOG
+ * \param names: Parameter names
+ * \return Message as compact JSON
+ */
+QString Subscription::encode(const QString &key, const QStringList &names) {
+    QJsonObject object;
+    object.insert(key, QJsonArray::fromStringList(names));
+    return QString::fromUtf8(QJsonDocument(object)
+                             .toJson(QJsonDocument::Compact));
+}
+
+/*!
+ * \brief Reads the names of a control message
+ *
+ * \param message: Received message
+ * \param key: \b JSON_SUBSCRIBE or \b JSON_CATALOG
+ * \param names: Set to the names of the message
+ * \return True: Message is a valid control message of the key
+ */
+bool Subscription::decode(const QString &message, const QString &key,
+                          QStringList &names) {
+    if (!isMessage(message, key)) return false;
+
+    QJsonValue value = QJsonDocument::fromJson(message.toUtf8())
+                                                .object().value(key);
+    if (!value.isArray()) return false;
+
+    names.clear();
+    for (const QJsonValue &name : value.toArray()) {
+        if (name.isString()) names << name.toString();
+    }
+    return true;
+}
+
+/*!
+ * \brief Checks if a message starts with the key of a control message
+ *
+ * Only the start of the message is checked, so parameter messages
+ * are told apart without parsing them
+ *
+ * \param message: Received message
+ * \param key: \b JSON_SUBSCRIBE or \b JSON_CATALOG
+ * \return True: Message starts with the key
+ */
+bool Subscription::isMessage(const QString &message, const QString &key) {
+    int i = 0;
+    while (i < message.size() && message.at(i).isSpace()) i++;
+    if (i >= message.size() || message.at(i) != '{') return false;
+    i++;
+    while (i < message.size() && message.at(i).isSpace()) i++;
+
+    return message.midRef(i, key.size() + 2) == '"' + key + '"';
+}
+
+/*!
+ * \brief Builds a probe echo message
+ *
+ * \param sent: Send times of the probes in microseconds since epoch
+ * \param displayed: Time the probes were rendered
+ * \return Message as compact JSON
+ */
+QString Subscription::encodeEcho(const QVector<qint64> &sent,
+                                 qint64 displayed) {
+    QJsonArray times;
+    for (qint64 time : sent) times.append(double(time));
+    QJsonObject object;
+    object.insert(JSON_ECHO, times);
+    object.insert(JSON_DISPLAYED, double(displayed));
+    return QString::fromUtf8(QJsonDocument(object)
+                             .toJson(QJsonDocument::Compact));
+}
+
+/*!
+ * \brief Reads a probe echo message
+ *
+ * \param message: Received message
+ * \param sent: Set to the send times of the probes
+ * \param displayed: Set to the time the probes were rendered
+ * \return True: Message is a valid echo message
+ */
+bool Subscription::decodeEcho(const QString &message, QVector<qint64> &sent,
+                              qint64 &displayed) {
+    if (!isMessage(message, JSON_ECHO)) return false;
+
+    QJsonObject object = QJsonDocument::fromJson(message.toUtf8()).object();
+    QJsonValue times = object.value(JSON_ECHO);
+    if (!times.isArray()) return false;
+
+    sent.clear();
+    for (const QJsonValue &time : times.toArray()) {
+        sent.append(qint64(time.toDouble()));
+    }
+    displayed = qint64(object.value(JSON_DISPLAYED).toDouble());
+    return true;
+}
@@ -0,0 +1,51 @@
+/*!
+ * \file subscription.h
+ *
+ * Control messages exchanged between MonitorScreen and a server.
+ *
+ * Sent by the client, an empty list subscribes to all parameters:
+ * {"subscribe":["name",...]}
+ *
+ * Sent by the server at a low rate to subscribed clients:
+ * {"catalog":["name",...]}
+ *
+ * Load generators send parameter \b PROBE_NAME with the send time in
+ * microseconds since epoch as its value. The client answers with the
+ * send times and the time the probes were rendered:
+ * {"echo":[sent,...],"displayed":time}
+ */
+#ifndef SUBSCRIPTION_H
+#define SUBSCRIPTION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+const QString JSON_SUBSCRIBE = "subscribe"; /*!< JSON field for the names
+                                                 a client subscribes to */
+const QString JSON_CATALOG = "catalog"; /*!< JSON field for the names
+                                             known by the server */
+const QString JSON_ECHO = "echo"; /*!< JSON field for echoed send times */
+const QString JSON_DISPLAYED = "displayed"; /*!< JSON field for the time
+                                                 echoed probes were rendered */
+const QString PROBE_NAME = "_probe"; /*!< Parameter name of latency probes,
+                                          never listed or displayed */
+
+/*!
+ * \brief Subscription class
+ *
+ * Encodes and decodes subscription, catalog and probe echo messages
+ */
+class Subscription {
+
+public:
+    static QString encode(const QString &key, const QStringList &names);
+    static bool decode(const QString &message, const QString &key,
+                       QStringList &names);
+    static bool isMessage(const QString &message, const QString &key);
+    static QString encodeEcho(const QVector<qint64> &sent, qint64 displayed);
+    static bool decodeEcho(const QString &message, QVector<qint64> &sent,
+                           qint64 &displayed);
+};
+
+#endif // SUBSCRIPTION_H
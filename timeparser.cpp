@@ -0,0 +1,221 @@
+/*!
+ * \file timeparser.cpp
+ */
+#include "timeparser.h"
+#include <QDateTime>
+#include <limits>
+
+namespace {
+
+/*!
+ * \brief Reads a fixed number of digits
+ *
+ * \param text: Parsed text
+ * \param position: Position of the first digit
+ * \param count: Number of digits
+ * \param value: Set to the value of the digits
+ * \return True: All characters are digits
+ */
+bool readDigits(QStringView text, int position, int count, int &value) {
+    if (position + count > text.size()) return false;
+    value = 0;
+    for (int i = position; i < position + count; i++) {
+        ushort c = text.at(i).unicode();
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+/*!
+ * \brief Reads optional fractional seconds as microseconds
+ *
+ * \param text: Parsed text
+ * \param position: Position of the decimal point, moved past the digits
+ * \return Microseconds, digits past the sixth are ignored
+ */
+qint64 readFraction(QStringView text, int &position) {
+    qint64 micros = 0;
+    if (position >= text.size() || text.at(position) != '.') return 0;
+    position++;
+    int digits = 0;
+    while (position < text.size() && text.at(position).isDigit()) {
+        if (digits < 6) {
+            micros = micros * 10 + text.at(position).digitValue();
+            digits++;
+        }
+        position++;
+    }
+    for (; digits < 6; digits++) micros *= 10;
+    return micros;
+}
+
+/*!
+ * \brief Returns the number of days from 1970-01-01 to a civil date
+ *
+ * Algorithm by Howard Hinnant
+ */
+qint64 daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    qint64 era = (year >= 0 ? year : year - 399) / 400;
+    qint64 yearOfEra = year - era * 400;
+    qint64 dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100
+                      + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+}
+
+/*!
+ * \brief TimeParser constructor
+ */
+TimeParser::TimeParser() : format(-1), lastTime(0),
+    offsetHour(std::numeric_limits<qint64>::min()), offsetSeconds(0) {}
+
+/*!
+ * \brief Parses a time into microseconds since epoch
+ *
+ * Repeated texts, such as the shared time of a batch, are parsed once
+ *
+ * \param text: Time field of a message
+ * \return Microseconds since epoch, 0 if the format is not recognized
+ */
+qint64 TimeParser::parse(const QString &text) {
+    if (text.isEmpty()) return 0;
+    if (text == lastText) return lastTime;
+
+    qint64 time = 0;
+    bool parsed = format >= 0 && parseFormat(format, text, time);
+    for (int i = 0; !parsed && i < TIME_FORMAT_COUNT; i++) {
+        if (i != format && parseFormat(i, text, time)) {
+            format = i;
+            parsed = true;
+        }
+    }
+    lastText = text;
+    lastTime = parsed ? time : 0;
+    return lastTime;
+}
+
+/*!
+ * \brief Parses a time in one format
+ *
+ * \param format: Format of the Format enum
+ * \param text: Parsed text
+ * \param time: Set to microseconds since epoch
+ * \return True: Text is in the format
+ */
+bool TimeParser::parseFormat(int format, QStringView text, qint64 &time) {
+    switch (format) {
+    case SlashFormat:
+        return parseDateTime(text, '/', QStringView(u" - "), false, time);
+    case IsoFormat:
+        return parseDateTime(text, '-', QStringView(u"T"), true, time)
+            || parseDateTime(text, '-', QStringView(u" "), true, time);
+    case EpochFormat:
+        return parseEpoch(text, time);
+    }
+    return false;
+}
+
+/*!
+ * \brief Parses a date and time of fixed layout
+ *
+ * \param text: Parsed text
+ * \param dateSeparator: Character between the date fields
+ * \param timeSeparator: Text between the date and the time
+ * \param zone: Determines, whether a zone may follow
+ * \param time: Set to microseconds since epoch
+ * \return True: Text has the layout
+ */
+bool TimeParser::parseDateTime(QStringView text, char dateSeparator,
+                               QStringView timeSeparator, bool zone,
+                               qint64 &time) {
+    int year, month, day, hour, minute, second;
+    int p = 10 + timeSeparator.size();
+    if (!readDigits(text, 0, 4, year) || !readDigits(text, 5, 2, month)
+            || !readDigits(text, 8, 2, day) || text.size() < p + 8
+            || text.at(4) != dateSeparator || text.at(7) != dateSeparator
+            || text.mid(10, timeSeparator.size()) != timeSeparator
+            || !readDigits(text, p, 2, hour) || text.at(p + 2) != ':'
+            || !readDigits(text, p + 3, 2, minute) || text.at(p + 5) != ':'
+            || !readDigits(text, p + 6, 2, second)) return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23
+            || minute > 59 || second > 60) return false;
+
+    p += 8;
+    qint64 micros = readFraction(text, p);
+    qint64 seconds = daysFromCivil(year, month, day) * 86400
+                     + hour * 3600 + minute * 60 + second;
+
+    if (zone && p < text.size() && text.at(p) == 'Z') {
+        p++;
+    }
+    else if (zone && p < text.size()
+             && (text.at(p) == '+' || text.at(p) == '-')) {
+        int offsetHours, offsetMinutes;
+        int sign = text.at(p) == '-' ? -1 : 1;
+        int minutes = text.size() > p + 3 && text.at(p + 3) == ':' ? p + 4
+                                                                    : p + 3;
+        if (!readDigits(text, p + 1, 2, offsetHours)
+                || !readDigits(text, minutes, 2, offsetMinutes)) return false;
+        seconds -= sign * (offsetHours * 3600 + offsetMinutes * 60);
+        p = minutes + 2;
+    }
+    else seconds -= localOffset(seconds);
+
+    if (p != text.size()) return false;
+    time = seconds * 1000000 + micros;
+    return true;
+}
+
+/*!
+ * \brief Parses a numeric epoch time
+ *
+ * The unit is chosen by magnitude, see \b EPOCH_SECONDS_MAX
+ * and \b EPOCH_MILLISECONDS_MAX
+ *
+ * \param text: Parsed text
+ * \param time: Set to microseconds since epoch
+ * \return True: Text is a number
+ */
+bool TimeParser::parseEpoch(QStringView text, qint64 &time) {
+    qint64 value = 0;
+    int p = 0;
+    while (p < text.size() && text.at(p).isDigit() && p < 18) {
+        value = value * 10 + text.at(p).digitValue();
+        p++;
+    }
+    if (!p) return false;
+    qint64 micros = readFraction(text, p);
+    if (p != text.size()) return false;
+
+    if (value < EPOCH_SECONDS_MAX) time = value * 1000000 + micros;
+    else if (value < EPOCH_MILLISECONDS_MAX) {
+        time = value * 1000 + micros / 1000;
+    }
+    else time = value;
+    return true;
+}
+
+/*!
+ * \brief Returns the UTC offset of a local time
+ *
+ * The offset is cached for the local hour, so QDateTime is consulted
+ * at most once per hour of parsed times
+ *
+ * \param localSeconds: Local time as seconds since epoch
+ * \return Offset in seconds
+ */
+qint64 TimeParser::localOffset(qint64 localSeconds) {
+    qint64 hour = localSeconds / 3600;
+    if (hour != offsetHour) {
+        QDateTime local = QDateTime::fromSecsSinceEpoch(localSeconds,
+                                                        Qt::UTC);
+        local.setTimeSpec(Qt::LocalTime);
+        offsetSeconds = local.offsetFromUtc();
+        offsetHour = hour;
+    }
+    return offsetSeconds;
+}
@@ -0,0 +1,53 @@
+/*!
+ * \file timeparser.h
+ */
+#ifndef TIMEPARSER_H
+#define TIMEPARSER_H
+
+#include <QString>
+#include <QStringView>
+
+const int TIME_FORMAT_COUNT = 3; /*!< Number of recognized time formats */
+const qint64 EPOCH_SECONDS_MAX = 100000000000LL; /*!< Numeric times below
+                                        this are seconds since epoch */
+const qint64 EPOCH_MILLISECONDS_MAX = 100000000000000LL; /*!< Numeric times
+                        below this are milliseconds, above microseconds */
+
+/*!
+ * \brief TimeParser class
+ *
+ * Parses the time field of messages into microseconds since epoch.
+ * Recognized formats are "yyyy/MM/dd - hh:mm:ss" and ISO 8601 dates,
+ * both with optional fractional seconds, and numeric epoch times in
+ * seconds, milliseconds or microseconds. The format that matched last
+ * is tried first, so a feed's format is detected once. Times without
+ * a zone are local time.
+ */
+class TimeParser {
+
+public:
+    TimeParser();
+
+    qint64 parse(const QString &text);
+
+private:
+    enum Format {
+        SlashFormat, /*!< yyyy/MM/dd - hh:mm:ss[.f] */
+        IsoFormat, /*!< yyyy-MM-ddThh:mm:ss[.f][Z|+hh:mm] */
+        EpochFormat /*!< Seconds, milliseconds or microseconds */
+    };
+
+    bool parseFormat(int format, QStringView text, qint64 &time);
+    bool parseDateTime(QStringView text, char dateSeparator,
+                       QStringView timeSeparator, bool zone, qint64 &time);
+    bool parseEpoch(QStringView text, qint64 &time);
+    qint64 localOffset(qint64 localSeconds);
+
+    int format; /*!< Format that matched last, -1 if none */
+    QString lastText; /*!< Text parsed last */
+    qint64 lastTime; /*!< Result of the text parsed last */
+    qint64 offsetHour; /*!< Local hour of the cached UTC offset */
+    qint64 offsetSeconds; /*!< Cached UTC offset of local time */
+};
+
+#endif // TIMEPARSER_H
@@ -0,0 +1,166 @@
+/*!
+ * \file trendchart.cpp
+ */
+#include "trendchart.h"
+#include <QPainter>
+#include <cmath>
+
+/*!
+ * \brief TrendChart constructor
+ */
+TrendChart::TrendChart(QWidget *parent) : QWidget(parent), store(0),
+    parameterId(-1), window(TREND_WINDOW), origin(0) {}
+
+/*!
+ * \brief Changes the plotted parameter
+ *
+ * \param store: Histories of all parameters
+ * \param id: Parameter ID, -1 to clear the chart
+ */
+void TrendChart::setSource(const HistoryStore *store, int id) {
+    this->store = store;
+    parameterId = id;
+    rebuild();
+}
+
+/*!
+ * \brief Changes the plotted time span
+ *
+ * \param milliseconds: Time span in milliseconds
+ */
+void TrendChart::setWindow(qint64 milliseconds) {
+    window = qMax<qint64>(milliseconds, 1);
+    rebuild();
+}
+
+/*!
+ * \brief Adds a new point of the plotted parameter
+ *
+ * Scrolls the chart when the point is newer than the right edge
+ *
+ * \param time: Receive time in milliseconds
+ * \param value: Numeric value
+ */
+void TrendChart::append(qint64 time, double value) {
+    if (columns.isEmpty()) return;
+    double right = origin + window;
+
+    if (time >= right) {
+        int shift = int((time - right) / columnWidth()) + 1;
+        if (shift >= columns.size()) columns.fill(TrendColumn());
+        else {
+            columns.remove(0, shift);
+            columns.insert(columns.size(), shift, TrendColumn());
+        }
+        origin += shift * columnWidth();
+    }
+    addPoint(time, value);
+    update();
+}
+
+/*!
+ * \brief Checks if the chart has any points to plot
+ */
+bool TrendChart::hasData() const {
+    return store && store->buffer(parameterId);
+}
+
+/*!
+ * \brief Draws each column as a vertical line from its minimum
+ * to its maximum, joined to the previous column
+ */
+void TrendChart::paintEvent(QPaintEvent *) {
+    double low = 0, high = 0;
+    bool found = false;
+
+    for (const TrendColumn &column : columns) {
+        if (!column.valid) continue;
+        low = found ? qMin(low, column.min) : column.min;
+        high = found ? qMax(high, column.max) : column.max;
+        found = true;
+    }
+    if (!found) return;
+    if (high == low) {
+        high += 1;
+        low -= 1;
+    }
+
+    QPainter painter(this);
+    painter.setPen(palette().color(QPalette::WindowText));
+    double scale = (height() - 2 * TREND_MARGIN) / (high - low);
+    int bottom = height() - TREND_MARGIN;
+    int previous = -1;
+
+    for (int x = 0; x < columns.size(); x++) {
+        const TrendColumn &column = columns[x];
+        if (!column.valid) continue;
+
+        if (previous >= 0) {
+            painter.drawLine(previous, bottom - int((columns[previous].last
+                                                     - low) * scale),
+                             x, bottom - int((column.first - low) * scale));
+        }
+        painter.drawLine(x, bottom - int((column.max - low) * scale),
+                         x, bottom - int((column.min - low) * scale));
+        previous = x;
+    }
+    painter.drawText(rect().adjusted(TREND_MARGIN, 0, 0, 0),
+                     Qt::AlignLeft | Qt::AlignTop, QString::number(high));
+    painter.drawText(rect().adjusted(TREND_MARGIN, 0, 0, 0),
+                     Qt::AlignLeft | Qt::AlignBottom, QString::number(low));
+}
+
+/*!
+ * \brief Recomputes the columns for the new width
+ */
+void TrendChart::resizeEvent(QResizeEvent *) {
+    rebuild();
+}
+
+/*!
+ * \brief Recomputes all columns from the history
+ *
+ * The newest point is placed in the last column
+ */
+void TrendChart::rebuild() {
+    columns.fill(TrendColumn(), qMax(width(), 1));
+    const HistoryBuffer *history = store ? store->buffer(parameterId) : 0;
+
+    if (history && history->count()) {
+        qint64 newest = history->at(history->count() - 1).time;
+        origin = newest + columnWidth() - window;
+
+        for (int i = history->lowerBound(qint64(std::ceil(origin)));
+             i < history->count(); i++) {
+            addPoint(history->at(i).time, history->at(i).value);
+        }
+    }
+    update();
+}
+
+/*!
+ * \brief Adds a point to its column
+ *
+ * \param time: Receive time in milliseconds
+ * \param value: Numeric value
+ */
+void TrendChart::addPoint(qint64 time, double value) {
+    int x = int((time - origin) / columnWidth());
+    if (x < 0 || x >= columns.size()) return;
+    TrendColumn &column = columns[x];
+
+    if (!column.valid) {
+        column.min = column.max = column.first = value;
+        column.valid = true;
+    }
+    column.min = qMin(column.min, value);
+    column.max = qMax(column.max, value);
+    column.last = value;
+}
+
+/*!
+ * \brief Returns the time span of a single column in milliseconds
+ */
+double TrendChart::columnWidth() const {
+    return double(window) / qMax(columns.size(), 1);
+}
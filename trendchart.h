@@ -0,0 +1,60 @@
+/*!
+ * \file trendchart.h
+ */
+#ifndef TRENDCHART_H
+#define TRENDCHART_H
+
+#include <QWidget>
+#include <QVector>
+#include "historybuffer.h"
+
+const int TREND_WINDOW = 60000; /*!< Default time span of the trend chart
+                                     in milliseconds */
+const int TREND_MARGIN = 4; /*!< Space around the plotted line in pixels */
+
+/*!
+ * \brief Minimum and maximum of the points drawn in one pixel column
+ */
+struct TrendColumn {
+    double min; /*!< Smallest value */
+    double max; /*!< Largest value */
+    double first; /*!< Oldest value */
+    double last; /*!< Newest value */
+    bool valid; /*!< Determines, whether the column has any points */
+};
+
+/*!
+ * \brief TrendChart class
+ *
+ * Plots the history of one parameter decimated into one min/max column
+ * per pixel, so drawing costs O(width) regardless of the number of
+ * points. New points update their column incrementally.
+ */
+class TrendChart : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TrendChart(QWidget *parent = 0);
+
+    void setSource(const HistoryStore *store, int id);
+    void setWindow(qint64 milliseconds);
+    void append(qint64 time, double value);
+    bool hasData() const;
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+
+private:
+    void rebuild();
+    void addPoint(qint64 time, double value);
+    double columnWidth() const;
+
+    QVector<TrendColumn> columns; /*!< Decimated points, one per pixel */
+    const HistoryStore *store; /*!< Histories of all parameters */
+    int parameterId; /*!< Plotted parameter ID, -1 if none */
+    qint64 window; /*!< Plotted time span in milliseconds */
+    double origin; /*!< Time at the left edge of the first column */
+};
+
+#endif // TRENDCHART_H
@@ -0,0 +1,124 @@
+/*!
+ * \file valueparser.cpp
+ */
+#include "valueparser.h"
+#include <cmath>
+
+/*!
+ * \brief Parses the number at the beginning of a value
+ *
+ * Accepts an optional sign, digits with an optional decimal point and
+ * an optional exponent. Whitespace before the number is skipped and
+ * anything after it, such as a unit, is ignored.
+ *
+ * \param text: Displayed value
+ * \param number: Receives the parsed number
+ * \return True: Value starts with a number
+ */
+bool ValueParser::parse(QStringView text, double &number) {
+    return parseNumber(text.data(), text.data() + text.size(), number)
+           != nullptr;
+}
+
+/*!
+ * \brief Parses the number and the unit of a value
+ *
+ * \param text: Displayed value
+ * \param number: Receives the parsed number
+ * \param unit: Receives the text after the number without surrounding
+ * whitespace, e.g. "V", pointing into \p text
+ * \return True: Value starts with a number
+ */
+bool ValueParser::parse(QStringView text, double &number, QStringView &unit) {
+    const QChar *end = text.data() + text.size();
+    const QChar *p = parseNumber(text.data(), end, number);
+    if (!p) return false;
+
+    while (p < end && p->unicode() == ' ') p++;
+    while (end > p && end[-1].unicode() == ' ') end--;
+    unit = QStringView(p, end - p);
+    return true;
+}
+
+/*!
+ * \brief Formats a number followed by its unit
+ *
+ * \param number: Value
+ * \param unit: Unit, empty if none
+ * \param isInteger: Determines, whether the value is shown without
+ * fraction and exponent, otherwise with \b VALUE_PRECISION digits
+ * \return Displayed value, e.g. "14.257 V"
+ */
+QString ValueParser::format(double number, const QString &unit,
+                            bool isInteger) {
+    QString text = isInteger ? QString::number(qint64(number))
+                             : QString::number(number, 'g', VALUE_PRECISION);
+    if (!unit.isEmpty()) {
+        text += QLatin1Char(' ');
+        text += unit;
+    }
+    return text;
+}
+
+/*!
+ * \brief Parses a number
+ *
+ * \param p: First character
+ * \param end: Character past the last one
+ * \param number: Receives the parsed number
+ * \return Character past the number, nullptr if there is no number
+ */
+const QChar *ValueParser::parseNumber(const QChar *p, const QChar *end,
+                                      double &number) {
+    while (p < end && p->unicode() == ' ') p++;
+
+    bool negative = false;
+    if (p < end && (p->unicode() == '-' || p->unicode() == '+')) {
+        negative = p->unicode() == '-';
+        p++;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool hasDigits = false, hasPoint = false;
+
+    for (; p < end; p++) {
+        ushort c = p->unicode();
+        if (c == '.' && !hasPoint) {
+            hasPoint = true;
+            continue;
+        }
+        if (c < '0' || c > '9') break;
+        hasDigits = true;
+
+        if (digits < VALUE_DIGITS_MAX) {
+            if (mantissa || c != '0') digits++;
+            mantissa = mantissa * 10 + (c - '0');
+            if (hasPoint) exponent--;
+        }
+        else if (!hasPoint) exponent++;
+    }
+    if (!hasDigits) return nullptr;
+
+    if (p + 1 < end && (p->unicode() == 'e' || p->unicode() == 'E')) {
+        const QChar *e = p + 1;
+        bool negativeExponent = false;
+        if (e->unicode() == '-' || e->unicode() == '+') {
+            negativeExponent = e->unicode() == '-';
+            e++;
+        }
+        if (e < end && e->unicode() >= '0' && e->unicode() <= '9') {
+            int value = 0;
+            for (; e < end && e->unicode() >= '0' && e->unicode() <= '9'; e++) {
+                if (value < 10000) value = value * 10 + (e->unicode() - '0');
+            }
+            exponent += negativeExponent ? -value : value;
+            p = e;
+        }
+    }
+
+    number = exponent < 0 ? mantissa / std::pow(10.0, -exponent)
+                          : mantissa * std::pow(10.0, exponent);
+    if (negative) number = -number;
+    return p;
+}
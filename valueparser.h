@@ -0,0 +1,33 @@
+/*!
+ * \file valueparser.h
+ */
+#ifndef VALUEPARSER_H
+#define VALUEPARSER_H
+
+#include <QStringView>
+#include <QString>
+
+const int VALUE_DIGITS_MAX = 19; /*!< Significant digits kept while parsing */
+const int VALUE_PRECISION = 10; /*!< Significant digits of formatted
+                                     floating point values */
+
+/*!
+ * \brief ValueParser class
+ *
+ * Parses numbers and units out of displayed values such as "14.257 V"
+ * without allocating, and formats binary numbers for display
+ */
+class ValueParser {
+
+public:
+    static bool parse(QStringView text, double &number);
+    static bool parse(QStringView text, double &number, QStringView &unit);
+    static QString format(double number, const QString &unit,
+                          bool isInteger);
+
+private:
+    static const QChar *parseNumber(const QChar *p, const QChar *end,
+                                    double &number);
+};
+
+#endif // VALUEPARSER_H
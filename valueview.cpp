@@ -0,0 +1,304 @@
+/*!
+ * \file valueview.cpp
+ */
+#include "valueview.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QFontMetrics>
+
+/*!
+ * \brief ValueView constructor
+ */
+ValueView::ValueView(QWidget *parent) : QWidget(parent), useAtlas(true),
+    cellTop(0), cellHeight(0), cellWidth(0) {
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    buildAtlas();
+}
+
+/*!
+ * \brief Returns the displayed text
+ */
+QString ValueView::text() const {
+    return value;
+}
+
+/*!
+ * \brief Changes the displayed text
+ *
+ * If every character keeps its position, only the cells
+ * of changed characters are repainted
+ *
+ * \param newText: Text to be displayed
+ */
+void ValueView::setText(const QString &newText) {
+    if (newText == value) return;
+    bool atlasText = addGlyphs(newText);
+
+    QVector<int> positions;
+    int top;
+    layoutCells(newText, atlasText, positions, top);
+
+    if (!atlasText || !useAtlas || positions != cellX || top != cellTop) {
+        value = newText;
+        useAtlas = atlasText;
+        cellX = positions;
+        cellTop = top;
+        update();
+        return;
+    }
+
+    QRegion changed;
+    for (int i = 0; i < newText.length(); i++) {
+        if (newText.at(i) != value.at(i)) changed += cellRect(i);
+    }
+    value = newText;
+    update(changed);
+}
+
+/*!
+ * \brief Copies the glyphs of the cells to be repainted from the atlas,
+ * or draws the text if it is not in the atlas
+ */
+void ValueView::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().color(QPalette::Window));
+    if (!useAtlas) {
+        painter.setFont(font());
+        painter.setPen(palette().color(QPalette::WindowText));
+        painter.drawText(cellX.first(), cellTop
+                         + QFontMetrics(font()).ascent(), value);
+        return;
+    }
+
+    const QPixmap &source = tintedAtlas();
+    qreal ratio = source.devicePixelRatio();
+    for (int i = 0; i < value.length(); i++) {
+        QRect target = cellRect(i);
+        if (!event->rect().intersects(target)) continue;
+        AtlasGlyph glyph = glyphs.value(value.at(i).unicode());
+        painter.drawPixmap(QRectF(target.topLeft(), QSizeF(glyph.source
+                                  .size()) / ratio), source,
+                           QRectF(glyph.source));
+    }
+}
+
+/*!
+ * \brief Centers the text in the new size
+ */
+void ValueView::resizeEvent(QResizeEvent *) {
+    layoutCells(value, useAtlas, cellX, cellTop);
+}
+
+/*!
+ * \brief Rebuilds the atlas when the font changes
+ *
+ * Palette changes only select another tinted copy of the atlas
+ */
+void ValueView::changeEvent(QEvent *event) {
+    if (event->type() == QEvent::FontChange) {
+        buildAtlas();
+        update();
+    }
+    else if (event->type() == QEvent::PaletteChange) update();
+    QWidget::changeEvent(event);
+}
+
+/*!
+ * \brief Renders the characters in \b ATLAS_CHARACTERS into a grid
+ * of cells leaving \b ATLAS_EXTRA cells for other characters
+ *
+ * No atlas is built if it would exceed \b ATLAS_SIZE_MAX
+ */
+void ValueView::buildAtlas() {
+    QFontMetrics metrics(font());
+    qreal ratio = devicePixelRatioF();
+    cellHeight = metrics.height();
+    cellWidth = qMax(metrics.horizontalAdvance('W'), 1);
+    for (QChar c : ATLAS_CHARACTERS) {
+        cellWidth = qMax(cellWidth, metrics.horizontalAdvance(c));
+    }
+
+    int rows = (ATLAS_CHARACTERS.length() + ATLAS_EXTRA + ATLAS_COLUMNS - 1)
+               / ATLAS_COLUMNS;
+    QSize size = QSize(cellWidth * ATLAS_COLUMNS, cellHeight * rows) * ratio;
+    glyphs.clear();
+    extraCharacters.clear();
+    tints.clear();
+    atlas = QPixmap();
+
+    if (size.width() <= ATLAS_SIZE_MAX && size.height() <= ATLAS_SIZE_MAX) {
+        atlas = QPixmap(size);
+        atlas.setDevicePixelRatio(ratio);
+        atlas.fill(Qt::transparent);
+        for (int i = 0; i < ATLAS_CHARACTERS.length(); i++) {
+            drawGlyph(i, ATLAS_CHARACTERS.at(i));
+        }
+    }
+    useAtlas = addGlyphs(value);
+    layoutCells(value, useAtlas, cellX, cellTop);
+}
+
+/*!
+ * \brief Makes sure every character of a text is in the atlas
+ *
+ * Missing characters replace the least recently used extra characters
+ * not in the text
+ *
+ * \param newText: Text to be displayed
+ * \return True: Text can be copied from the atlas
+ */
+bool ValueView::addGlyphs(const QString &newText) {
+    if (atlas.isNull()) return false;
+    QFontMetrics metrics(font());
+
+    for (QChar c : newText) {
+        QHash<ushort, AtlasGlyph>::const_iterator it =
+                glyphs.constFind(c.unicode());
+        if (it != glyphs.constEnd()) {
+            if (it.value().cell >= ATLAS_CHARACTERS.length()) {
+                extraCharacters.remove(extraCharacters.indexOf(c), 1);
+                extraCharacters += c;
+            }
+            continue;
+        }
+        if (c.isSurrogate() || metrics.horizontalAdvance(c) > cellWidth) {
+            return false;
+        }
+
+        int cell = ATLAS_CHARACTERS.length() + extraCharacters.length();
+        if (extraCharacters.length() >= ATLAS_EXTRA) {
+            int evicted = 0;
+            while (evicted < extraCharacters.length()
+                   && newText.contains(extraCharacters.at(evicted))) {
+                evicted++;
+            }
+            if (evicted == extraCharacters.length()) return false;
+            cell = glyphs.take(extraCharacters.at(evicted).unicode()).cell;
+            extraCharacters.remove(evicted, 1);
+        }
+        drawGlyph(cell, c);
+        extraCharacters += c;
+    }
+    return true;
+}
+
+/*!
+ * \brief Renders a character into an atlas cell
+ *
+ * The cell is also tinted into the cached copies of the atlas
+ *
+ * \param cell: Cell index
+ * \param c: Character
+ */
+void ValueView::drawGlyph(int cell, QChar c) {
+    QFontMetrics metrics(font());
+    qreal ratio = atlas.devicePixelRatio();
+    QRect area(QPoint((cell % ATLAS_COLUMNS) * cellWidth,
+                      (cell / ATLAS_COLUMNS) * cellHeight),
+               QSize(cellWidth, cellHeight));
+
+    QPainter painter(&atlas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(area, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setFont(font());
+    painter.setPen(Qt::black);
+    painter.drawText(area.topLeft() + QPoint(0, metrics.ascent()),
+                     QString(c));
+    painter.end();
+
+    AtlasGlyph glyph;
+    glyph.advance = metrics.horizontalAdvance(c);
+    glyph.source = QRect(area.topLeft() * ratio,
+                         QSize(glyph.advance, cellHeight) * ratio);
+    glyph.cell = cell;
+    glyphs.insert(c.unicode(), glyph);
+
+    for (auto i = tints.begin(); i != tints.end(); ++i) {
+        tint(i.value(), QColor::fromRgba(i.key()), area);
+    }
+}
+
+/*!
+ * \brief Copies an area of the atlas into a tinted copy
+ * in the given color
+ *
+ * \param tinted: Tinted copy of the atlas
+ * \param color: Text color
+ * \param area: Copied area in pixels
+ */
+void ValueView::tint(QPixmap &tinted, const QColor &color,
+                     const QRect &area) {
+    qreal ratio = atlas.devicePixelRatio();
+    QPainter painter(&tinted);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(QRectF(area), atlas, QRectF(QRectF(area).topLeft()
+                       * ratio, QSizeF(area.size()) * ratio));
+    painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    painter.fillRect(area, color);
+}
+
+/*!
+ * \brief Returns the atlas in the current text color
+ *
+ * The glyph masks are colored with a single composited fill,
+ * copies are kept for the last \b ATLAS_TINTS_MAX colors
+ */
+const QPixmap &ValueView::tintedAtlas() {
+    QRgb color = palette().color(QPalette::WindowText).rgba();
+    QHash<QRgb, QPixmap>::const_iterator it = tints.constFind(color);
+    if (it != tints.constEnd()) return it.value();
+    if (tints.size() >= ATLAS_TINTS_MAX) tints.clear();
+
+    QPixmap tinted(atlas.size());
+    tinted.setDevicePixelRatio(atlas.devicePixelRatio());
+    tinted.fill(Qt::transparent);
+    tint(tinted, QColor::fromRgba(color), QRect(QPoint(), atlas.size()
+                                        / atlas.devicePixelRatio()));
+    return *tints.insert(color, tinted);
+}
+
+/*!
+ * \brief Computes the position of each character with the text centered
+ *
+ * Text in the atlas is positioned by the cached advances of its glyphs,
+ * other text is measured once as a whole
+ *
+ * \param layoutText: Text to be positioned
+ * \param perCharacter: Determines, whether each character is positioned
+ * from the atlas, otherwise only the edges of the text
+ * \param positions: Receives the left edge of each character followed
+ * by the right edge of the text
+ * \param top: Receives the top edge of the characters
+ */
+void ValueView::layoutCells(const QString &layoutText, bool perCharacter,
+                            QVector<int> &positions, int &top) {
+    top = (height() - cellHeight) / 2;
+    if (!perCharacter) {
+        int total = QFontMetrics(font()).horizontalAdvance(layoutText);
+        positions.resize(2);
+        positions[0] = (width() - total) / 2;
+        positions[1] = positions[0] + total;
+        return;
+    }
+
+    positions.resize(layoutText.length() + 1);
+    int x = 0;
+    for (int i = 0; i < layoutText.length(); i++) {
+        positions[i] = x;
+        x += glyphs.value(layoutText.at(i).unicode()).advance;
+    }
+    positions.last() = x;
+    int left = (width() - x) / 2;
+    for (int &position : positions) position += left;
+}
+
+/*!
+ * \brief Returns the widget area of a displayed character
+ *
+ * \param i: Character index
+ */
+QRect ValueView::cellRect(int i) const {
+    return QRect(cellX[i], cellTop, cellX[i + 1] - cellX[i], cellHeight);
+}
@@ -0,0 +1,85 @@
+/*!
+ * \file valueview.h
+ */
+#ifndef VALUEVIEW_H
+#define VALUEVIEW_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QHash>
+#include <QVector>
+
+const QString ATLAS_CHARACTERS = "0123456789+-.,:% "; /*!< Glyphs rendered
+                                        into the atlas in advance */
+const int ATLAS_EXTRA = 16; /*!< Cells for other characters, the least
+                                 recently used one is replaced first */
+const int ATLAS_COLUMNS = 8; /*!< Cells per atlas row */
+const int ATLAS_SIZE_MAX = 4096; /*!< Longest atlas side in device pixels,
+                                      larger fonts are drawn as text */
+const int ATLAS_TINTS_MAX = 4; /*!< Tinted copies of the atlas kept */
+
+/*!
+ * \brief Position of a glyph in the atlas
+ */
+struct AtlasGlyph {
+    QRect source; /*!< Glyph in the atlas in device pixels */
+    int cell; /*!< Index of the atlas cell */
+    int advance; /*!< Horizontal advance in pixels */
+};
+
+/*!
+ * \brief ValueView class
+ *
+ * Displays the main value by copying pre-rendered glyphs from a pixmap
+ * atlas. Changing the text repaints only the character cells that
+ * changed when the layout of the other cells stays the same. Characters
+ * are positioned by the advances measured when they were rendered,
+ * so a new value is laid out without shaping the text.
+ *
+ * The atlas is a grid of the fixed \b ATLAS_CHARACTERS and
+ * \b ATLAS_EXTRA cells for other characters. Glyphs are stored as
+ * a mask and tinted with the text color, so palette changes do not
+ * rebuild the atlas. A glyph added to an extra cell is tinted into the
+ * cached copies. Texts with characters that do not fit, such as
+ * surrogate pairs, and fonts too large for the atlas are drawn as text.
+ */
+class ValueView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit ValueView(QWidget *parent = 0);
+
+    QString text() const;
+    void setText(const QString &newText);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void changeEvent(QEvent *event);
+
+private:
+    void buildAtlas();
+    bool addGlyphs(const QString &newText);
+    void drawGlyph(int cell, QChar c);
+    void tint(QPixmap &tinted, const QColor &color, const QRect &area);
+    const QPixmap &tintedAtlas();
+    void layoutCells(const QString &layoutText, bool perCharacter,
+                     QVector<int> &positions, int &top);
+    QRect cellRect(int i) const;
+
+    QString value; /*!< Displayed text */
+    bool useAtlas; /*!< Determines, whether the text is copied from the
+                        atlas, otherwise it is drawn as text */
+    QPixmap atlas; /*!< Glyph masks, null if the font is too large */
+    QHash<QRgb, QPixmap> tints; /*!< Atlas tinted in each text color */
+    QHash<ushort, AtlasGlyph> glyphs; /*!< Atlas cell of each character */
+    QString extraCharacters; /*!< Characters in the extra cells, least
+                                  recently used first */
+    QVector<int> cellX; /*!< Left edge of each displayed character,
+                             followed by the right edge of the text */
+    int cellTop; /*!< Top edge of the displayed characters */
+    int cellHeight; /*!< Height of a character cell */
+    int cellWidth; /*!< Width of a character cell */
+};
+
+#endif // VALUEVIEW_H